@@ -0,0 +1,669 @@
+#include <benchmark/benchmark.h>
+
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <cmath>
+#include <functional>
+#include <random>
+
+#include "../mainwindow.h"
+#include "../common/transactionreader.h"
+#include "../common/vectorreader.h"
+#include "../common/distancematrix.h"
+#include "../common/mahalanobis.h"
+
+
+// Micro-benchmarks of the mining and distance steps.
+//
+// Inputs are the bundled files, selected by their number of items (4, 5 or
+// 6), and synthetic data drawn from a fixed seed, so every run times exactly
+// the same work. Results are exported with Google Benchmark's own flags:
+//
+//   arules_bench --benchmark_out=results.json --benchmark_out_format=json
+//
+// parseVector reports its errors on the Distance tab, so its loop is timed on
+// VectorReader directly, the reader every vector input goes through.
+//
+// With --input=<file> [--min-support=<s>] the Input/* cases run every tab's
+// miner once over that file, read included, for bench/scalability.py:
+//
+//   arules_bench --input=quest.txt --benchmark_filter=Input/
+
+
+// Seed of every synthetic input.
+static const quint64 benchmarkSeed = 20240601;
+
+// Support used where a step needs the frequent itemsets of an input.
+static const double benchmarkSupport = 0.1;
+
+
+class BenchmarkAccess
+{
+public:
+    static bool gridReadFile(Grid &grid, const QString &filePath, QSet<int> &items)
+    {
+        grid._inputFilePath = filePath;
+        grid._transactions.clear();
+        bool success = grid.readFile(items);
+        grid._transactionsCount = grid._transactions.size();
+        return success;
+    }
+
+    static void gridSetTransactions(Grid &grid, const QVector<QVector<int>> &transactions)
+    {
+        grid._transactions = transactions;
+        grid._transactionsCount = transactions.size();
+    }
+
+    static QVector<QVector<int>> gridFindAllSets(Grid &grid, const QSet<int> &items)
+    {
+        return grid.findAllSets(items);
+    }
+
+    static QVector<int> gridFindAllSupports(Grid &grid, const QVector<QVector<int>> &sets)
+    {
+        return grid.findAllSupports(sets);
+    }
+
+    static QMap<QVector<int>, QVector<QVector<int>>> gridFindChildren(Grid &grid, QVector<QVector<int>> &sets)
+    {
+        return grid.findChildren(sets);
+    }
+
+    static QMap<QVector<int>, int> gridFrequentItemsets(Grid &grid, const double minSupport)
+    {
+        return grid.generateFrequentItemsets(minSupport);
+    }
+
+    static int gridClosedAndMaximal(Grid &grid, const QMap<QVector<int>, int> &frequentItemsets)
+    {
+        QVector<QVector<int>> closedItemsets = grid.findClosedItemsets(frequentItemsets);
+        QVector<QVector<int>> maximalItemsets = grid.findMaximalItemsets(frequentItemsets);
+        return grid.findClosedAndMaximalItemsets(closedItemsets, maximalItemsets).size();
+    }
+
+    static int buildFpTree(FrequentItemset &tab, const QVector<QVector<int>> &transactions, const double minSupport)
+    {
+        tab._transactions = transactions;
+        tab._itemsFrequencies.clear();
+        tab._treeNodes.clear();
+        tab._itemsNodes.clear();
+
+        tab.findItemFrequencies();
+        tab.sortTransactions();
+        tab._minSupport = minSupport * tab._sortedTransactions.size();
+        tab.removeRareItemsets();
+        tab.buildTree();
+
+        return tab._treeNodes.size();
+    }
+
+    static int fpGrowth(FrequentItemset &tab, const QVector<QVector<int>> &transactions, const double minSupport)
+    {
+        buildFpTree(tab, transactions, minSupport);
+        tab._threadsCount = 1;
+        tab.mineParallel();
+
+        return tab._frequentItemsets.size();
+    }
+
+    static bool loadRareDatabase(const QString &filePath, QVector<QVector<int>> &database)
+    {
+        return MainWindow::loadRareDatabase(filePath, database);
+    }
+
+    static QMap<QVector<int>, int> aprioriRare(const QString &filePath, const double minSupport)
+    {
+        QMap<QVector<int>, int> minimalRare;
+        MainWindow::findAprioriRare(filePath, minSupport, minimalRare);
+        return minimalRare;
+    }
+
+    static double minkowskiDistance(const QVector<double> &a, const QVector<double> &b, const double p)
+    {
+        return MainWindow::minkowskiDistance(a, b, p);
+    }
+
+    static double cosineDistance(const QVector<double> &a, const QVector<double> &b)
+    {
+        return MainWindow::cosineDistance(a, b);
+    }
+
+    static int hammingDistance(const BitVectorSet &vectors)
+    {
+        return MainWindow::hammingDistance(vectors);
+    }
+
+    static double jaccardCoefficient(const BitVectorSet &vectors)
+    {
+        return MainWindow::jaccardCoefficient(vectors);
+    }
+};
+
+
+static QString gridInput(const int itemsCount)
+{
+    return QString(ARULES_RESOURCES_DIR) + QString("/Grid/input%1_100000.txt").arg(itemsCount);
+}
+
+
+static QString frequentItemsetInput(const int itemsCount)
+{
+    return QString(ARULES_RESOURCES_DIR) + QString("/Frequent Itemset/input%1_10000.txt").arg(itemsCount);
+}
+
+
+static QVector<QVector<int>> readTransactions(const QString &filePath)
+{
+    QVector<QVector<int>> transactions;
+    TransactionReader reader(filePath);
+    if(!reader.open()) {
+        return transactions;
+    }
+
+    QVector<int> transaction;
+    while(reader.next(transaction)) {
+        std::sort(transaction.begin(), transaction.end());
+        transactions.append(transaction);
+    }
+
+    return transactions;
+}
+
+
+static QVector<QVector<int>> syntheticTransactions(const int transactionsCount, const int itemsCount)
+{
+    // Item i occurs with probability 1 / (1 + i / 4), so a few items are dense
+    // and the rest thin out, which gives every level some frequent itemsets.
+    std::mt19937_64 generator(benchmarkSeed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    QVector<QVector<int>> transactions;
+    transactions.reserve(transactionsCount);
+    for(int t = 0; t < transactionsCount; t++) {
+        QVector<int> transaction;
+        for(int item = 1; item <= itemsCount; item++) {
+            if(uniform(generator) < 1.0 / (1.0 + (item - 1) / 4.0)) {
+                transaction.append(item);
+            }
+        }
+        if(transaction.isEmpty()) {
+            transaction.append(1 + static_cast<int>(generator() % itemsCount));
+        }
+        transactions.append(transaction);
+    }
+
+    return transactions;
+}
+
+
+static bool writeTransactions(const QString &filePath, const QVector<QVector<int>> &transactions)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    for(const QVector<int> &transaction : transactions) {
+        for(int i = 0; i < transaction.size(); i++) {
+            out << (i > 0 ? " " : "") << transaction[i];
+        }
+        out << "\n";
+    }
+
+    return true;
+}
+
+
+static QVector<double> syntheticVector(const int dimension, const quint64 stream)
+{
+    std::mt19937_64 generator(benchmarkSeed + stream);
+    std::normal_distribution<double> normal(0, 1);
+
+    QVector<double> vector(dimension);
+    for(double &value : vector) {
+        value = normal(generator);
+    }
+
+    return vector;
+}
+
+
+static QVector<double> syntheticBits(const int dimension, const quint64 stream)
+{
+    std::mt19937_64 generator(benchmarkSeed + stream);
+
+    QVector<double> vector(dimension);
+    for(double &value : vector) {
+        value = generator() & 1;
+    }
+
+    return vector;
+}
+
+
+static QSet<int> itemsOf(const QVector<QVector<int>> &transactions)
+{
+    QSet<int> items;
+    for(const QVector<int> &transaction : transactions) {
+        for(int item : transaction) {
+            items.insert(item);
+        }
+    }
+
+    return items;
+}
+
+
+// Input of a mining benchmark: a bundled file when the first argument is 0,
+// synthetic transactions of the given size otherwise.
+static QVector<QVector<int>> miningInput(const benchmark::State &state, const bool grid)
+{
+    if(state.range(0) == 0) {
+        int itemsCount = static_cast<int>(state.range(1));
+        return readTransactions(grid ? gridInput(itemsCount) : frequentItemsetInput(itemsCount));
+    }
+
+    return syntheticTransactions(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+}
+
+
+static void miningArguments(benchmark::internal::Benchmark *benchmark, const QVector<int> &syntheticItems)
+{
+    benchmark->ArgNames({"transactions", "items"});
+    for(int itemsCount : {4, 5, 6}) {
+        benchmark->Args({0, itemsCount});
+    }
+    for(int transactionsCount : {10000, 100000}) {
+        for(int itemsCount : syntheticItems) {
+            benchmark->Args({transactionsCount, itemsCount});
+        }
+    }
+}
+
+
+static void BM_GridReadFile(benchmark::State &state)
+{
+    // A private copy keeps the sidecar cache out of the resources directory.
+    QTemporaryDir directory;
+    QString filePath = directory.filePath("input.txt");
+    QFile::copy(gridInput(static_cast<int>(state.range(0))), filePath);
+    bool cached = state.range(1) != 0;
+
+    // The first read writes the sidecar, so the cached case reads once
+    // before timing and every timed read is a cache hit. The uncached case
+    // never writes it and times the text parse alone.
+    Grid grid;
+    if(cached) {
+        QSet<int> items;
+        if(!BenchmarkAccess::gridReadFile(grid, filePath, items)) {
+            state.SkipWithError("Unable to read the input file");
+            return;
+        }
+    }
+    TransactionCache::setWriteEnabled(cached);
+
+    for(auto _ : state) {
+        QSet<int> items;
+        if(!BenchmarkAccess::gridReadFile(grid, filePath, items)) {
+            state.SkipWithError("Unable to read the input file");
+            break;
+        }
+        benchmark::DoNotOptimize(items);
+    }
+    TransactionCache::setWriteEnabled(true);
+
+    state.SetBytesProcessed(state.iterations() * QFileInfo(filePath).size());
+}
+BENCHMARK(BM_GridReadFile)
+    ->ArgNames({"items", "cached"})
+    ->ArgsProduct({{4, 5, 6}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+
+static void BM_ParseVector(benchmark::State &state)
+{
+    int dimension = static_cast<int>(state.range(0));
+    QTemporaryDir directory;
+    QString filePath = directory.filePath("vector.txt");
+    {
+        QFile file(filePath);
+        file.open(QIODevice::WriteOnly | QIODevice::Text);
+        QTextStream out(&file);
+        out.setRealNumberPrecision(17);
+        QVector<double> vector = syntheticVector(dimension, 0);
+        for(int i = 0; i < dimension; i++) {
+            out << (i > 0 ? "," : "") << vector[i];
+        }
+        out << "\n";
+    }
+
+    QVector<double> vector;
+    QVector<double> row;
+    for(auto _ : state) {
+        VectorReader reader(filePath);
+        reader.open();
+        vector.clear();
+        while(reader.next(row)) {
+            vector.append(row);
+        }
+        benchmark::DoNotOptimize(vector.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * QFileInfo(filePath).size());
+}
+BENCHMARK(BM_ParseVector)->ArgName("dimension")->RangeMultiplier(100)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+
+static void BM_GridFindAllSupports(benchmark::State &state)
+{
+    Grid grid;
+    QVector<QVector<int>> transactions = miningInput(state, true);
+    BenchmarkAccess::gridSetTransactions(grid, transactions);
+    QVector<QVector<int>> sets = BenchmarkAccess::gridFindAllSets(grid, itemsOf(transactions));
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(BenchmarkAccess::gridFindAllSupports(grid, sets));
+    }
+
+    state.counters["sets"] = sets.size();
+    state.SetItemsProcessed(state.iterations() * transactions.size());
+}
+BENCHMARK(BM_GridFindAllSupports)
+    ->Apply([](benchmark::internal::Benchmark *benchmark) { miningArguments(benchmark, {8}); })
+    ->Unit(benchmark::kMillisecond);
+
+
+static void BM_GridFindChildren(benchmark::State &state)
+{
+    QSet<int> items;
+    for(int item = 1; item <= state.range(0); item++) {
+        items.insert(item);
+    }
+
+    Grid grid;
+    QVector<QVector<int>> sets = BenchmarkAccess::gridFindAllSets(grid, items);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(BenchmarkAccess::gridFindChildren(grid, sets));
+    }
+
+    state.counters["sets"] = sets.size();
+}
+BENCHMARK(BM_GridFindChildren)->ArgName("items")->DenseRange(4, 10, 2)->Unit(benchmark::kMillisecond);
+
+
+static void BM_GridClosedAndMaximal(benchmark::State &state)
+{
+    Grid grid;
+    BenchmarkAccess::gridSetTransactions(grid, miningInput(state, true));
+    QMap<QVector<int>, int> frequentItemsets = BenchmarkAccess::gridFrequentItemsets(grid, benchmarkSupport);
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(BenchmarkAccess::gridClosedAndMaximal(grid, frequentItemsets));
+    }
+
+    state.counters["itemsets"] = frequentItemsets.size();
+}
+BENCHMARK(BM_GridClosedAndMaximal)
+    ->Apply([](benchmark::internal::Benchmark *benchmark) { miningArguments(benchmark, {10}); })
+    ->Unit(benchmark::kMillisecond);
+
+
+static void BM_FpTreeBuild(benchmark::State &state)
+{
+    FrequentItemset tab;
+    QVector<QVector<int>> transactions = miningInput(state, false);
+
+    int nodesCount = 0;
+    for(auto _ : state) {
+        nodesCount = BenchmarkAccess::buildFpTree(tab, transactions, benchmarkSupport / 10);
+    }
+
+    state.counters["nodes"] = nodesCount;
+    state.SetItemsProcessed(state.iterations() * transactions.size());
+}
+BENCHMARK(BM_FpTreeBuild)
+    ->Apply([](benchmark::internal::Benchmark *benchmark) { miningArguments(benchmark, {20, 50}); })
+    ->Unit(benchmark::kMillisecond);
+
+
+static void BM_AprioriRare(benchmark::State &state)
+{
+    QTemporaryDir directory;
+    QString filePath = directory.filePath("input.txt");
+    if(state.range(0) == 0) {
+        QFile::copy(frequentItemsetInput(static_cast<int>(state.range(1))), filePath);
+    } else {
+        writeTransactions(filePath, miningInput(state, false));
+    }
+
+    // The first load writes the sidecar cache; every timed run reads it.
+    QMap<QVector<int>, int> minimalRare = BenchmarkAccess::aprioriRare(filePath, benchmarkSupport);
+    for(auto _ : state) {
+        minimalRare = BenchmarkAccess::aprioriRare(filePath, benchmarkSupport);
+        benchmark::DoNotOptimize(minimalRare);
+    }
+
+    state.counters["itemsets"] = minimalRare.size();
+}
+BENCHMARK(BM_AprioriRare)
+    ->Apply([](benchmark::internal::Benchmark *benchmark) { miningArguments(benchmark, {20}); })
+    ->Unit(benchmark::kMillisecond);
+
+
+static void BM_MinkowskiDistance(benchmark::State &state)
+{
+    QVector<double> a = syntheticVector(static_cast<int>(state.range(0)), 1);
+    QVector<double> b = syntheticVector(static_cast<int>(state.range(0)), 2);
+    double p = state.range(1);
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(BenchmarkAccess::minkowskiDistance(a, b, p));
+    }
+
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+BENCHMARK(BM_MinkowskiDistance)->ArgNames({"dimension", "p"})->ArgsProduct({{16, 1024, 65536}, {1, 2, 3}});
+
+
+static void BM_CosineDistance(benchmark::State &state)
+{
+    QVector<double> a = syntheticVector(static_cast<int>(state.range(0)), 1);
+    QVector<double> b = syntheticVector(static_cast<int>(state.range(0)), 2);
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(BenchmarkAccess::cosineDistance(a, b));
+    }
+
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+BENCHMARK(BM_CosineDistance)->ArgName("dimension")->RangeMultiplier(64)->Range(16, 65536);
+
+
+static void BM_HammingDistance(benchmark::State &state)
+{
+    BitVectorSet vectors;
+    vectors.append(syntheticBits(static_cast<int>(state.range(0)), 1));
+    vectors.append(syntheticBits(static_cast<int>(state.range(0)), 2));
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(BenchmarkAccess::hammingDistance(vectors));
+    }
+
+    state.SetLabel(BitVectorSet::getInstructionSet().toStdString());
+    state.SetItemsProcessed(state.iterations() * vectors.getDimension());
+}
+BENCHMARK(BM_HammingDistance)->ArgName("dimension")->RangeMultiplier(64)->Range(64, 262144);
+
+
+static void BM_JaccardCoefficient(benchmark::State &state)
+{
+    BitVectorSet vectors;
+    vectors.append(syntheticBits(static_cast<int>(state.range(0)), 1));
+    vectors.append(syntheticBits(static_cast<int>(state.range(0)), 2));
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(BenchmarkAccess::jaccardCoefficient(vectors));
+    }
+
+    state.SetLabel(BitVectorSet::getInstructionSet().toStdString());
+    state.SetItemsProcessed(state.iterations() * vectors.getDimension());
+}
+BENCHMARK(BM_JaccardCoefficient)->ArgName("dimension")->RangeMultiplier(64)->Range(64, 262144);
+
+
+static void BM_MahalanobisDistance(benchmark::State &state)
+{
+    int dimension = static_cast<int>(state.range(0));
+    VectorSet reference;
+    for(int sample = 0; sample < 4 * dimension; sample++) {
+        reference.append(syntheticVector(dimension, 100 + sample));
+    }
+
+    Mahalanobis mahalanobis;
+    if(!mahalanobis.fit(reference)) {
+        state.SkipWithError(mahalanobis.getErrorString().toStdString().c_str());
+        return;
+    }
+
+    QVector<double> a = syntheticVector(dimension, 1);
+    QVector<double> b = syntheticVector(dimension, 2);
+    std::vector<double> workspace(dimension);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(mahalanobis.distance(a.constData(), b.constData(), workspace.data()));
+    }
+}
+BENCHMARK(BM_MahalanobisDistance)->ArgName("dimension")->RangeMultiplier(4)->Range(8, 512);
+
+
+static void BM_DistanceMatrix(benchmark::State &state)
+{
+    DistanceMatrix::Metric metric = static_cast<DistanceMatrix::Metric>(state.range(0));
+    int rowsCount = static_cast<int>(state.range(1));
+    const int dimension = 64;
+
+    VectorSet vectors;
+    BitVectorSet bits;
+    for(int row = 0; row < rowsCount; row++) {
+        vectors.append(syntheticVector(dimension, 1000 + row));
+        bits.append(syntheticBits(dimension, 1000 + row));
+    }
+
+    DistanceMatrix matrix(metric, 2, 1);
+    auto writer = [](const int, const int, const int, const std::vector<double> &values) {
+        benchmark::DoNotOptimize(values.data());
+        return true;
+    };
+
+    bool binary = metric == DistanceMatrix::Hamming || metric == DistanceMatrix::Jaccard;
+    for(auto _ : state) {
+        if(binary) {
+            matrix.compute(bits, bits, writer);
+        } else {
+            matrix.compute(vectors, vectors, writer);
+        }
+    }
+
+    state.SetLabel(matrix.getInstructionSet().toStdString());
+    state.SetItemsProcessed(state.iterations() * rowsCount * rowsCount);
+}
+BENCHMARK(BM_DistanceMatrix)
+    ->ArgNames({"metric", "rows"})
+    ->ArgsProduct({
+        {DistanceMatrix::Minkowski, DistanceMatrix::Cosine, DistanceMatrix::Hamming, DistanceMatrix::Jaccard},
+        {256, 1024}
+    })
+    ->Unit(benchmark::kMillisecond);
+
+
+// The miner of every tab over one input file, each run once with its read.
+static void registerInputBenchmarks(const QString &filePath, const double minSupport)
+{
+    // Every case parses the text, as a first run of the tab does.
+    auto inputBenchmark = [](const char *name, const std::function<int()> &mine) {
+        benchmark::RegisterBenchmark(name, [mine](benchmark::State &state) {
+            TransactionCache::setWriteEnabled(false);
+            int itemsetsCount = 0;
+            for(auto _ : state) {
+                itemsetsCount = mine();
+            }
+            TransactionCache::setWriteEnabled(true);
+            state.counters["itemsets"] = itemsetsCount;
+        })->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+    };
+
+    inputBenchmark("Input/Grid", [filePath, minSupport]() {
+        Grid grid;
+        QSet<int> items;
+        if(!BenchmarkAccess::gridReadFile(grid, filePath, items)) {
+            return -1;
+        }
+        return static_cast<int>(BenchmarkAccess::gridFrequentItemsets(grid, minSupport).size());
+    });
+    inputBenchmark("Input/FpGrowth", [filePath, minSupport]() {
+        FrequentItemset tab;
+        return BenchmarkAccess::fpGrowth(tab, readTransactions(filePath), minSupport);
+    });
+    inputBenchmark("Input/AprioriRare", [filePath, minSupport]() {
+        return static_cast<int>(BenchmarkAccess::aprioriRare(filePath, minSupport).size());
+    });
+    inputBenchmark("Input/RpGrowth", [filePath, minSupport]() {
+        QVector<QVector<int>> database;
+        if(!BenchmarkAccess::loadRareDatabase(filePath, database)) {
+            return -1;
+        }
+        return static_cast<int>(RPGrowth().mine(database, 0, minSupport).size());
+    });
+    inputBenchmark("Input/MrgExp", [filePath, minSupport]() {
+        QVector<QVector<int>> database;
+        if(!BenchmarkAccess::loadRareDatabase(filePath, database)) {
+            return -1;
+        }
+        return static_cast<int>(MRGExp().mine(database, static_cast<int>(std::ceil(minSupport * database.size()))).size());
+    });
+}
+
+
+int main(int argc, char *argv[])
+{
+    // --input and --min-support are taken out before Google Benchmark sees
+    // the arguments, since it rejects the ones it does not know.
+    QString inputFilePath;
+    double inputMinSupport = benchmarkSupport;
+    int argumentsCount = 1;
+    for(int i = 1; i < argc; i++) {
+        QString argument = QString::fromLocal8Bit(argv[i]);
+        if(argument.startsWith("--input=")) {
+            inputFilePath = argument.mid(8);
+        } else if(argument.startsWith("--min-support=")) {
+            inputMinSupport = argument.mid(14).toDouble();
+        } else {
+            argv[argumentsCount++] = argv[i];
+        }
+    }
+    argc = argumentsCount;
+
+    // The tabs create widgets, which need an application but no display.
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication application(argc, argv);
+
+    if(!inputFilePath.isEmpty()) {
+        registerInputBenchmarks(inputFilePath, inputMinSupport);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+r"""Runs the command line miners and the tab miners over a grid of generated
+inputs and plots runtime and peak memory against the number of transactions.
+
+Inputs come from "AssociationRules generate", so a grid is the same for the
+same seed on machines with the same math library; generated files are kept in
+the work directory and reused by later runs. Every miner runs as its own
+process. The command line miners are timed by wall clock. The Grid, FP-Growth
+and rare itemset tab miners have no command line entry; they run as the
+Input/* cases of arules_bench, which time the read and the mining of one run.
+Memory is the largest_process_peak_rss_bytes column: ru_maxrss from wait4(),
+i.e. the peak RSS of the largest single process in the tree. For the
+distributed miner that is the largest of the coordinator and its workers, not
+the sum of the workers running at the same time.
+
+    scalability.py --binary build/AssociationRules --bench build/arules_bench \
+        --transactions 1e4 1e5 1e6 1e7
+
+Results go to results.csv and, when matplotlib is installed, scalability.png
+in the work directory. The Grid tab enumerates every subset of every
+transaction, so it only finishes on short transactions; runs past --timeout
+are killed together with their worker processes and recorded as "timeout".
+"""
+
+import argparse
+import csv
+import json
+import os
+import signal
+import subprocess
+import sys
+import time
+
+
+# Command line arguments of each miner, after --input, --output and the support.
+MINERS = {
+    "apriori": ["mine"],
+    "partition": ["mine", "--memory-budget", "64"],
+    "distributed": ["mine", "--workers", "2"],
+    "sampling": ["mine", "--sample-size", "10000"],
+    "lossy": ["stream"],
+}
+
+# arules_bench case of each tab miner.
+BENCH_MINERS = {
+    "grid": "Input/Grid",
+    "fp-growth": "Input/FpGrowth",
+    "apriori-rare": "Input/AprioriRare",
+    "rp-growth": "Input/RpGrowth",
+    "mrg-exp": "Input/MrgExp",
+}
+
+
+def generate(binary, directory, model, transactions, items, avg_size, seed):
+    path = os.path.join(directory, f"{model}_D{transactions}_N{items}_T{avg_size:g}_s{seed}.txt")
+    if not os.path.exists(path):
+        subprocess.run([
+            binary, "generate", "--output", path, "--model", model,
+            "--transactions", str(transactions), "--items", str(items),
+            "--avg-size", str(avg_size), "--seed", str(seed),
+        ], check=True)
+
+    return path
+
+
+def run(command, timeout):
+    """Returns (seconds, peak RSS of the largest process in the tree in bytes,
+    exit status) of one run."""
+    # A session of its own puts the distributed miner's workers in the run's
+    # process group, so a timeout kills them along with the coordinator.
+    start = time.perf_counter()
+    process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, start_new_session=True)
+    while True:
+        pid, status, usage = os.wait4(process.pid, os.WNOHANG)
+        if pid != 0:
+            break
+        if time.perf_counter() - start > timeout:
+            os.killpg(process.pid, signal.SIGKILL)
+            pid, status, usage = os.wait4(process.pid, 0)
+            return timeout, usage.ru_maxrss * 1024, "timeout"
+        time.sleep(0.01)
+    process.returncode = os.waitstatus_to_exitcode(status)
+
+    # ru_maxrss is in kilobytes on Linux, and is the maximum over the process
+    # and its waited-for descendants, not their sum.
+    return time.perf_counter() - start, usage.ru_maxrss * 1024, str(process.returncode)
+
+
+def run_bench(bench, case, path, min_support, work_dir, timeout):
+    """Runs one Input/* case of arules_bench; the time is the one it reports."""
+    output = os.path.join(work_dir, "bench.json")
+    command = [
+        bench, f"--input={path}", f"--min-support={min_support}",
+        f"--benchmark_filter=^{case}/", f"--benchmark_out={output}", "--benchmark_out_format=json",
+    ]
+    seconds, peak, status = run(command, timeout)
+    if status != "0":
+        return seconds, peak, status
+
+    with open(output) as file:
+        results = json.load(file)["benchmarks"]
+    if not results or results[0].get("error_occurred"):
+        return seconds, peak, "error"
+
+    return results[0]["real_time"] / 1000, peak, status
+
+
+def plot(rows, path):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print("matplotlib is not installed, skipping the plot", file=sys.stderr)
+        return
+
+    figure, (runtime, memory) = plt.subplots(1, 2, figsize=(12, 5))
+    series = sorted({(row["miner"], row["items"]) for row in rows if row["status"] == "0"})
+    for miner, items in series:
+        points = sorted(
+            (row["transactions"], row["seconds"], row["largest_process_peak_rss_bytes"])
+            for row in rows
+            if row["miner"] == miner and row["items"] == items and row["status"] == "0"
+        )
+        label = f"{miner}, N={items}"
+        runtime.plot([p[0] for p in points], [p[1] for p in points], marker="o", label=label)
+        memory.plot([p[0] for p in points], [p[2] / 2**20 for p in points], marker="o", label=label)
+
+    for axes, title in ((runtime, "Runtime [s]"), (memory, "Peak RSS of the largest process [MB]")):
+        axes.set_xscale("log")
+        axes.set_yscale("log")
+        axes.set_xlabel("Transactions")
+        axes.set_title(title)
+        axes.grid(True, which="both", alpha=0.3)
+    runtime.legend(fontsize="small")
+
+    figure.tight_layout()
+    figure.savefig(path, dpi=120)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--binary", required=True, help="AssociationRules executable")
+    parser.add_argument("--bench", help="arules_bench executable, runs the tab miners")
+    parser.add_argument("--work-dir", default="scalability", help="generated inputs and results")
+    parser.add_argument("--model", default="quest", choices=["quest", "dense", "long-tail"])
+    parser.add_argument("--transactions", nargs="+", type=float, default=[1e4, 1e5, 1e6])
+    parser.add_argument("--items", nargs="+", type=int, default=[100, 1000])
+    parser.add_argument("--avg-size", type=float, default=10)
+    parser.add_argument("--min-support", type=float, default=0.01)
+    parser.add_argument("--miners", nargs="+", choices=list(MINERS) + list(BENCH_MINERS),
+                        help="default: the command line miners, and the tab miners with --bench")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--timeout", type=float, default=600, help="seconds per run")
+    args = parser.parse_args()
+    if args.miners is None:
+        args.miners = list(MINERS) + (list(BENCH_MINERS) if args.bench else [])
+    if not args.bench and any(miner in BENCH_MINERS for miner in args.miners):
+        parser.error("the tab miners need --bench")
+
+    os.makedirs(args.work_dir, exist_ok=True)
+    output = os.path.join(args.work_dir, "output.txt")
+
+    rows = []
+    for items in args.items:
+        for transactions in sorted(int(d) for d in args.transactions):
+            path = generate(args.binary, args.work_dir, args.model, transactions, items, args.avg_size, args.seed)
+            for miner in args.miners:
+                if miner in BENCH_MINERS:
+                    seconds, peak, status = run_bench(
+                        args.bench, BENCH_MINERS[miner], path, args.min_support, args.work_dir, args.timeout)
+                else:
+                    command = [args.binary] + MINERS[miner][:1] + [
+                        "--input", path, "--output", output, "--min-support", str(args.min_support),
+                    ] + MINERS[miner][1:]
+                    seconds, peak, status = run(command, args.timeout)
+                rows.append({
+                    "miner": miner, "model": args.model, "transactions": transactions, "items": items,
+                    "bytes": os.path.getsize(path), "seconds": seconds, "largest_process_peak_rss_bytes": peak, "status": status,
+                })
+                print(f"{miner:12} N={items:<6} D={transactions:<9} {seconds:9.3f} s {peak / 2**20:9.1f} MB  {status}")
+
+    with open(os.path.join(args.work_dir, "results.csv"), "w", newline="") as file:
+        writer = csv.DictWriter(file, fieldnames=list(rows[0]))
+        writer.writeheader()
+        writer.writerows(rows)
+
+    plot(rows, os.path.join(args.work_dir, "scalability.png"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,616 @@
+#include "commandline.h"
+
+
+bool CommandLine::isCommand(int argc, char *argv[])
+{
+    if(argc < 2) {
+        return false;
+    }
+
+    QString command = QString::fromLocal8Bit(argv[1]);
+
+    return command == "mine" || command == "worker" || command == "stream" || command == "window"
+        || command == "similar" || command == "generate";
+}
+
+
+int CommandLine::run(const QStringList &arguments)
+{
+    QString command = arguments.value(1);
+
+    // Drop the command so the parsers see "<program> --option ...".
+    QStringList commandArguments = arguments;
+    commandArguments.removeAt(1);
+
+    if(command == "mine") {
+        return runMine(commandArguments);
+    }
+    if(command == "worker") {
+        return runWorker(commandArguments);
+    }
+    if(command == "stream") {
+        return runStream(commandArguments);
+    }
+    if(command == "window") {
+        return runWindow(commandArguments);
+    }
+    if(command == "similar") {
+        return runSimilar(commandArguments);
+    }
+    if(command == "generate") {
+        return runGenerate(commandArguments);
+    }
+
+    return fail("Unknown command: " + command);
+}
+
+
+int CommandLine::runMine(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.addOptions({
+        {"input", "Transactions file.", "file"},
+        {"output", "Output file in the Grid tab format.", "file"},
+        {"min-support", "Minimum support in (0, 1].", "support"},
+        {"memory-budget", "Memory budget in MB, 0 = in memory.", "MB", "0"},
+        {"workers", "Number of worker processes.", "n", "1"},
+        {"incremental", "Only mine lines appended since the previous run."},
+        {"sample-size", "Mine a sample and verify its negative border.", "n", "0"},
+        {"profile", "Write phase timings and counters as JSON, - = standard error.", "file"},
+        {"trace", "Write a Chrome trace of the run, viewable in Perfetto.", "file"}
+    });
+    if(!parse(parser, arguments)) {
+        return 1;
+    }
+    Profiler::setEnabled(parser.isSet("profile"));
+    Tracer::setEnabled(parser.isSet("trace"));
+
+    if(!parser.isSet("input") || !parser.isSet("output") || !parser.isSet("min-support")) {
+        return fail("--input, --output and --min-support are required");
+    }
+
+    bool success;
+    double minSupport = parser.value("min-support").toDouble(&success);
+    if(!success || minSupport <= 0 || minSupport > 1) {
+        return fail("Minimum support must be in scope (0, 1]");
+    }
+
+    double memoryBudget = parser.value("memory-budget").toDouble(&success);
+    if(!success || memoryBudget < 0) {
+        return fail("Memory budget must be a non-negative number of megabytes");
+    }
+
+    int workersCount = parser.value("workers").toInt(&success);
+    if(!success || workersCount < 1) {
+        return fail("Worker processes must be a positive integer");
+    }
+
+    qint64 memoryBudgetBytes = static_cast<qint64>(memoryBudget * 1024 * 1024);
+
+    int sampleSize = parser.value("sample-size").toInt(&success);
+    if(!success || sampleSize < 0) {
+        return fail("Sample size must be a positive integer");
+    }
+
+    int modesCount = (parser.isSet("incremental") ? 1 : 0) + (sampleSize > 0 ? 1 : 0)
+        + (workersCount > 1 || memoryBudgetBytes > 0 ? 1 : 0);
+    if(modesCount > 1) {
+        return fail("--incremental, --sample-size and --workers/--memory-budget cannot be combined");
+    }
+
+    QMap<QVector<int>, int> frequentItemsets;
+    int transactionsCount;
+    if(parser.isSet("incremental")) {
+        IncrementalMiner miner(parser.value("input"), parser.value("output") + ".fup");
+        if(!miner.mine(minSupport, frequentItemsets)) {
+            return fail(miner.getErrorString());
+        }
+        transactionsCount = miner.getTransactionsCount();
+
+        QTextStream err(stderr);
+        if(miner.isIncremental()) {
+            err << "Incremental update: " << miner.getAppendedTransactionsCount() << " appended transactions, "
+                << miner.getRescannedCount() << " itemsets recounted over the previous data\n";
+        } else {
+            err << "No usable previous run, mined " << transactionsCount << " transactions\n";
+        }
+    } else if(sampleSize > 0) {
+        SamplingMiner miner(parser.value("input"), sampleSize);
+        QMap<QVector<int>, int> negativeBorder;
+        if(!miner.mine(minSupport, frequentItemsets, negativeBorder)) {
+            return fail(miner.getErrorString());
+        }
+        transactionsCount = miner.getTransactionsCount();
+
+        QTextStream err(stderr);
+        err << "Sample of " << miner.getSampleCount() << " transactions mined at support "
+            << miner.getLoweredSupport() << ", " << miner.getPassesCount() << " counting pass(es)"
+            << (miner.isFallbackUsed() ? ", exact fallback was required" : "") << "\n";
+    } else if(workersCount > 1) {
+        DistributedMiner miner(parser.value("input"), workersCount, memoryBudgetBytes);
+        if(!miner.mine(minSupport, frequentItemsets)) {
+            return fail(miner.getErrorString());
+        }
+        transactionsCount = miner.getTransactionsCount();
+    } else {
+        PartitionMiner miner(
+            parser.value("input"),
+            memoryBudgetBytes > 0 ? memoryBudgetBytes : std::numeric_limits<qint64>::max()
+        );
+        if(!miner.mine(minSupport, frequentItemsets)) {
+            return fail(miner.getErrorString());
+        }
+        transactionsCount = miner.getTransactionsCount();
+    }
+
+    PROFILE_COUNT("transactions scanned", transactionsCount);
+    PROFILE_COUNT("itemsets emitted", frequentItemsets.size());
+
+    QString errorString;
+    {
+        PROFILE_SCOPE("save");
+        if(!ItemsetWriter::write(parser.value("output"), frequentItemsets, transactionsCount, errorString)) {
+            return fail(errorString);
+        }
+    }
+
+    return writeProfile(parser);
+}
+
+
+int CommandLine::runWorker(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.addOptions({
+        {"input", "Transactions file.", "file"},
+        {"begin", "First byte of the range.", "offset", "0"},
+        {"end", "End of the range, -1 = end of file.", "offset", "-1"},
+        {"mode", "mine or count.", "mode"},
+        {"min-support", "Minimum support in (0, 1].", "support"},
+        {"memory-budget", "Memory budget in bytes, 0 = in memory.", "bytes", "0"}
+    });
+    if(!parse(parser, arguments)) {
+        return 1;
+    }
+
+    QString filePath = parser.value("input");
+    qint64 begin = parser.value("begin").toLongLong();
+    qint64 end = parser.value("end").toLongLong();
+
+    if(parser.value("mode") == "mine") {
+        return DistributedMiner::mineRange(
+            filePath,
+            begin,
+            end,
+            parser.value("min-support").toDouble(),
+            parser.value("memory-budget").toLongLong()
+        );
+    }
+    if(parser.value("mode") == "count") {
+        return DistributedMiner::countRange(filePath, begin, end);
+    }
+
+    return fail("Unknown worker mode: " + parser.value("mode"));
+}
+
+
+int CommandLine::runStream(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.addOptions({
+        {"input", "Transactions file, - = standard input.", "file", "-"},
+        {"output", "Snapshot file in the Grid tab format.", "file"},
+        {"min-support", "Minimum support in (0, 1].", "support"},
+        {"error", "Maximal support error, default = min-support / 10.", "error"},
+        {"snapshot-interval", "Transactions between snapshots.", "n", "100000"},
+        {"batch-size", "Transactions buffered per batch.", "n", "50000"},
+        {"follow", "Wait for lines appended to the input file."}
+    });
+    if(!parse(parser, arguments)) {
+        return 1;
+    }
+
+    if(!parser.isSet("output") || !parser.isSet("min-support")) {
+        return fail("--output and --min-support are required");
+    }
+
+    bool success;
+    double minSupport = parser.value("min-support").toDouble(&success);
+    if(!success || minSupport <= 0 || minSupport > 1) {
+        return fail("Minimum support must be in scope (0, 1]");
+    }
+
+    double error = minSupport / 10;
+    if(parser.isSet("error")) {
+        error = parser.value("error").toDouble(&success);
+        if(!success || error <= 0 || error >= minSupport) {
+            return fail("Error must be in scope (0, min-support)");
+        }
+    }
+
+    qint64 snapshotInterval = parser.value("snapshot-interval").toLongLong(&success);
+    if(!success || snapshotInterval < 1) {
+        return fail("Snapshot interval must be a positive integer");
+    }
+
+    int batchSize = parser.value("batch-size").toInt(&success);
+    if(!success || batchSize < 1) {
+        return fail("Batch size must be a positive integer");
+    }
+
+    TransactionReader reader(parser.value("input"));
+    reader.setFollow(parser.isSet("follow"));
+    if(!reader.open()) {
+        return fail(reader.getErrorString());
+    }
+
+    LossyCounter counter(error, batchSize);
+    qint64 nextSnapshot = snapshotInterval;
+    qint64 lastSnapshot = -1;
+
+    QVector<int> transaction;
+    while(reader.next(transaction)) {
+        if(!counter.add(transaction) || counter.getTransactionsCount() < nextSnapshot) {
+            continue;
+        }
+
+        if(!writeSnapshot(parser.value("output"), counter.getFrequentItemsets(minSupport), counter.getTransactionsCount())) {
+            return 1;
+        }
+        lastSnapshot = counter.getTransactionsCount();
+        nextSnapshot = (lastSnapshot / snapshotInterval + 1) * snapshotInterval;
+    }
+    if(reader.hasError()) {
+        return fail(reader.getErrorString());
+    }
+
+    counter.flush();
+    if(counter.getTransactionsCount() != lastSnapshot) {
+        if(!writeSnapshot(parser.value("output"), counter.getFrequentItemsets(minSupport), counter.getTransactionsCount())) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+int CommandLine::runWindow(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.addOptions({
+        {"input", "Transactions file, - = standard input.", "file", "-"},
+        {"output", "Snapshot file in the Grid tab format.", "file"},
+        {"min-support", "Minimum support in (0, 1].", "support"},
+        {"window", "Number of most recent transactions mined.", "n"},
+        {"snapshot-interval", "Transactions between snapshots.", "n", "100000"},
+        {"follow", "Wait for lines appended to the input file."}
+    });
+    if(!parse(parser, arguments)) {
+        return 1;
+    }
+
+    if(!parser.isSet("output") || !parser.isSet("min-support") || !parser.isSet("window")) {
+        return fail("--output, --min-support and --window are required");
+    }
+
+    bool success;
+    double minSupport = parser.value("min-support").toDouble(&success);
+    if(!success || minSupport <= 0 || minSupport > 1) {
+        return fail("Minimum support must be in scope (0, 1]");
+    }
+
+    int windowSize = parser.value("window").toInt(&success);
+    if(!success || windowSize < 1) {
+        return fail("Window must be a positive integer");
+    }
+
+    qint64 snapshotInterval = parser.value("snapshot-interval").toLongLong(&success);
+    if(!success || snapshotInterval < 1) {
+        return fail("Snapshot interval must be a positive integer");
+    }
+
+    TransactionReader reader(parser.value("input"));
+    reader.setFollow(parser.isSet("follow"));
+    if(!reader.open()) {
+        return fail(reader.getErrorString());
+    }
+
+    SlidingWindowTree tree(windowSize);
+    qint64 transactionsRead = 0;
+
+    QVector<int> transaction;
+    while(reader.next(transaction)) {
+        tree.add(transaction);
+        transactionsRead++;
+
+        if(transactionsRead % snapshotInterval == 0) {
+            if(!writeSnapshot(parser.value("output"), tree.getFrequentItemsets(minSupport), tree.getTransactionsCount())) {
+                return 1;
+            }
+        }
+    }
+    if(reader.hasError()) {
+        return fail(reader.getErrorString());
+    }
+
+    if(transactionsRead % snapshotInterval != 0 || transactionsRead == 0) {
+        if(!writeSnapshot(parser.value("output"), tree.getFrequentItemsets(minSupport), tree.getTransactionsCount())) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+int CommandLine::runSimilar(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.addOptions({
+        {"input", "Transactions file.", "file"},
+        {"output", "Pairs file, one \"i j similarity\" line per pair.", "file"},
+        {"threshold", "Report all pairs with Jaccard similarity >= t; copies of a transaction are paired with its first copy only.", "t"},
+        {"top-k", "Report the k most similar transactions.", "k"},
+        {"transaction", "Only for this transaction (0-based), default = all.", "i"},
+        {"bands", "LSH bands.", "b", "20"},
+        {"rows", "MinHash values per band.", "r", "5"},
+        {"threads", "Threads, 0 = all cores.", "n", "0"},
+        {"profile", "Write phase timings and counters as JSON, - = standard error.", "file"},
+        {"trace", "Write a Chrome trace of the run, viewable in Perfetto.", "file"}
+    });
+    if(!parse(parser, arguments)) {
+        return 1;
+    }
+    Profiler::setEnabled(parser.isSet("profile"));
+    Tracer::setEnabled(parser.isSet("trace"));
+
+    if(!parser.isSet("input") || !parser.isSet("output") || parser.isSet("threshold") == parser.isSet("top-k")) {
+        return fail("--input, --output and one of --threshold and --top-k are required");
+    }
+
+    bool success;
+    double threshold = 0;
+    int topK = 0;
+    if(parser.isSet("threshold")) {
+        threshold = parser.value("threshold").toDouble(&success);
+        if(!success || threshold <= 0 || threshold > 1) {
+            return fail("Threshold must be in scope (0, 1]");
+        }
+    } else {
+        topK = parser.value("top-k").toInt(&success);
+        if(!success || topK < 1) {
+            return fail("Top-k must be a positive integer");
+        }
+    }
+
+    int transaction = -1;
+    if(parser.isSet("transaction")) {
+        transaction = parser.value("transaction").toInt(&success);
+        if(!success || transaction < 0 || topK == 0) {
+            return fail("--transaction takes a non-negative index and requires --top-k");
+        }
+    }
+
+    int bandsCount = parser.value("bands").toInt(&success);
+    int rowsPerBand = success ? parser.value("rows").toInt(&success) : 0;
+    if(!success || bandsCount < 1 || rowsPerBand < 1) {
+        return fail("Bands and rows must be positive integers");
+    }
+
+    int threadsCount = parser.value("threads").toInt(&success);
+    if(!success || threadsCount < 0) {
+        return fail("Threads must be a positive integer");
+    }
+
+    QVector<QVector<int>> transactions;
+    {
+        PROFILE_SCOPE("read");
+        TransactionReader reader(parser.value("input"));
+        if(!reader.open()) {
+            return fail(reader.getErrorString());
+        }
+
+        QVector<int> items;
+        while(reader.next(items)) {
+            transactions.append(items);
+        }
+        if(reader.hasError()) {
+            return fail(reader.getErrorString());
+        }
+    }
+    PROFILE_COUNT("transactions scanned", transactions.size());
+    if(transaction >= transactions.size()) {
+        return fail(QString("The input holds %1 transactions").arg(transactions.size()));
+    }
+
+    MinHashIndex index(bandsCount, rowsPerBand, threadsCount);
+    {
+        PROFILE_SCOPE("index");
+        index.build(transactions);
+    }
+
+    QVector<MinHashIndex::SimilarPair> pairs;
+    {
+        PROFILE_SCOPE("search");
+        if(topK == 0) {
+            pairs = index.pairsAbove(threshold);
+        } else if(transaction >= 0) {
+            pairs = index.topK(transaction, topK);
+        } else {
+            pairs = index.topKForAll(topK);
+        }
+    }
+    PROFILE_COUNT("candidates generated", index.getCandidatesCount());
+    PROFILE_COUNT("itemsets emitted", pairs.size());
+
+    {
+        PROFILE_SCOPE("save");
+        QSaveFile file(parser.value("output"));
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            return fail("Unable to open the output file");
+        }
+
+        QTextStream out(&file);
+        for(const MinHashIndex::SimilarPair &pair : pairs) {
+            out << pair.first << " " << pair.second << " " << pair.similarity << "\n";
+        }
+        out.flush();
+
+        if(!file.commit()) {
+            return fail("Unable to write the output file");
+        }
+    }
+
+    QTextStream err(stderr);
+    err << transactions.size() << " transactions indexed (" << index.getInstructionSet() << "), "
+        << index.getCandidatesCount() << " candidates verified, " << pairs.size() << " pairs written\n";
+
+    return writeProfile(parser);
+}
+
+
+int CommandLine::runGenerate(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.addOptions({
+        {"output", "Transactions file, - = standard output.", "file"},
+        {"model", "quest, dense or long-tail.", "model", "quest"},
+        {"transactions", "Number of transactions (D).", "D", "100000"},
+        {"avg-size", "Average transaction size (T); attributes of the dense model.", "T", "10"},
+        {"items", "Number of items (N).", "N", "1000"},
+        {"patterns", "Number of potentially frequent patterns (L), quest model.", "L", "2000"},
+        {"pattern-size", "Average pattern size (I), quest model.", "I", "4"},
+        {"skew", "Zipf exponent of the long-tail model.", "s", "1"},
+        {"seed", "Random seed; the same seed gives the same file on a given platform.", "n", "0"}
+    });
+    if(!parse(parser, arguments)) {
+        return 1;
+    }
+
+    if(!parser.isSet("output")) {
+        return fail("--output is required");
+    }
+
+    QMap<QString, QuestGenerator::Model> models = {
+        {"quest", QuestGenerator::Quest},
+        {"dense", QuestGenerator::Dense},
+        {"long-tail", QuestGenerator::LongTail}
+    };
+    if(!models.contains(parser.value("model"))) {
+        return fail("Model must be quest, dense or long-tail");
+    }
+
+    bool success;
+    qint64 transactionsCount = parser.value("transactions").toLongLong(&success);
+    if(!success || transactionsCount < 0) {
+        return fail("Transactions must be a positive integer");
+    }
+
+    double averageSize = parser.value("avg-size").toDouble(&success);
+    if(!success || averageSize < 1) {
+        return fail("Average size must be at least 1");
+    }
+
+    int itemsCount = parser.value("items").toInt(&success);
+    if(!success || itemsCount < 1) {
+        return fail("Items must be a positive integer");
+    }
+
+    int patternsCount = parser.value("patterns").toInt(&success);
+    double patternSize = success ? parser.value("pattern-size").toDouble(&success) : 0;
+    if(!success || patternsCount < 1 || patternSize < 1) {
+        return fail("Patterns must be a positive integer and pattern size at least 1");
+    }
+
+    double skew = parser.value("skew").toDouble(&success);
+    if(!success || skew < 0) {
+        return fail("Skew must be a non-negative number");
+    }
+
+    quint64 seed = parser.value("seed").toULongLong(&success);
+    if(!success) {
+        return fail("Seed must be a non-negative integer");
+    }
+
+    QuestGenerator generator(models.value(parser.value("model")), transactionsCount, averageSize, itemsCount, seed);
+    generator.setPatterns(patternsCount, patternSize);
+    generator.setSkew(skew);
+
+    QElapsedTimer timer;
+    timer.start();
+    if(!generator.generate(parser.value("output"))) {
+        return fail(generator.getErrorString());
+    }
+
+    double seconds = std::max<qint64>(1, timer.nsecsElapsed()) / 1e9;
+    QTextStream err(stderr);
+    err << transactionsCount << " transactions, " << generator.getBytesWritten() << " bytes written in "
+        << seconds << " s (" << generator.getBytesWritten() / seconds / (1 << 20) << " MB/s)\n";
+
+    return 0;
+}
+
+
+bool CommandLine::writeSnapshot(
+    const QString &filePath,
+    const QMap<QVector<int>, int> &frequentItemsets,
+    const qint64 transactionsCount
+)
+{
+    // Replace the snapshot atomically so readers never see a partial file.
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        fail("Unable to open the output file");
+        return false;
+    }
+
+    QTextStream out(&file);
+    ItemsetWriter::write(out, frequentItemsets, transactionsCount);
+    out.flush();
+
+    if(!file.commit()) {
+        fail("Unable to write the output file");
+        return false;
+    }
+
+    QTextStream err(stderr);
+    err << "Snapshot: " << transactionsCount << " transactions, "
+        << frequentItemsets.size() << " frequent itemsets\n";
+
+    return true;
+}
+
+
+int CommandLine::writeProfile(const QCommandLineParser &parser)
+{
+    QString errorString;
+    if(parser.isSet("profile") && !Profiler::writeJson(parser.value("profile"), errorString)) {
+        return fail(errorString);
+    }
+    if(parser.isSet("trace") && !Tracer::writeJson(parser.value("trace"), errorString)) {
+        return fail(errorString);
+    }
+
+    return 0;
+}
+
+
+bool CommandLine::parse(QCommandLineParser &parser, const QStringList &arguments)
+{
+    if(!parser.parse(arguments)) {
+        fail(parser.errorText());
+        return false;
+    }
+
+    return true;
+}
+
+
+int CommandLine::fail(const QString &message)
+{
+    QTextStream err(stderr);
+    err << "Error: " << message << "\n";
+
+    return 1;
+}
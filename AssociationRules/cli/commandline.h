@@ -0,0 +1,70 @@
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QVector>
+#include <QTextStream>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QSaveFile>
+#include <QElapsedTimer>
+
+#include <limits>
+
+#include "../common/partitionminer.h"
+#include "../common/distributedminer.h"
+#include "../common/incrementalminer.h"
+#include "../common/samplingminer.h"
+#include "../common/itemsetwriter.h"
+#include "../common/lossycounter.h"
+#include "../common/slidingwindowtree.h"
+#include "../common/transactionreader.h"
+#include "../common/minhashindex.h"
+#include "../common/questgenerator.h"
+#include "../common/profiler.h"
+
+
+// Headless entry points of the executable. The first argument selects the
+// command; anything else starts the GUI.
+//
+//   mine    --input <file> --output <file> --min-support <s>
+//           [--memory-budget <MB>] [--workers <n>] [--incremental]
+//           [--sample-size <n>] [--profile <file|->] [--trace <file>]
+//   stream  --input <file|-> --output <file> --min-support <s>
+//           [--error <e>] [--snapshot-interval <n>] [--batch-size <n>] [--follow]
+//   window  --input <file|-> --output <file> --min-support <s> --window <n>
+//           [--snapshot-interval <n>] [--follow]
+//   similar --input <file> --output <file> (--threshold <t> | --top-k <k>)
+//           [--transaction <i>] [--bands <b>] [--rows <r>] [--threads <n>]
+//           [--profile <file|->] [--trace <file>]
+//   generate --output <file|-> [--model quest|dense|long-tail] [--transactions <D>]
+//           [--avg-size <T>] [--items <N>] [--patterns <L>] [--pattern-size <I>]
+//           [--skew <s>] [--seed <n>]
+//   worker  internal, started by DistributedMiner
+class CommandLine
+{
+public:
+    static bool isCommand(int argc, char *argv[]);
+    static int run(const QStringList &arguments);
+
+private:
+    static int runMine(const QStringList &arguments);
+    static int runWorker(const QStringList &arguments);
+    static int runStream(const QStringList &arguments);
+    static int runWindow(const QStringList &arguments);
+    static int runSimilar(const QStringList &arguments);
+    static int runGenerate(const QStringList &arguments);
+    static bool writeSnapshot(
+        const QString &filePath,
+        const QMap<QVector<int>, int> &frequentItemsets,
+        const qint64 transactionsCount
+    );
+    static int writeProfile(const QCommandLineParser &parser);
+    static bool parse(QCommandLineParser &parser, const QStringList &arguments);
+    static int fail(const QString &message);
+};
+
+
+#endif // COMMANDLINE_H
@@ -0,0 +1,235 @@
+#include "apriori.h"
+
+#include <climits>
+
+
+CandidateTrie::CandidateTrie()
+{
+    _nodes.append(Node{{}, {}, 0, false});
+    _candidatesCount = 0;
+}
+
+
+int CandidateTrie::getCandidatesCount()
+{
+    return _candidatesCount;
+}
+
+
+QMap<QVector<int>, int> CandidateTrie::getCounts()
+{
+    QMap<QVector<int>, int> counts;
+    QVector<int> prefix;
+    collect(0, prefix, counts);
+
+    return counts;
+}
+
+
+void CandidateTrie::insert(const QVector<int> &itemset)
+{
+    int node = 0;
+    for(int item : itemset) {
+        const QVector<int> &items = _nodes[node].items;
+        auto position = std::lower_bound(items.begin(), items.end(), item);
+        int index = position - items.begin();
+
+        if(position != items.end() && *position == item) {
+            node = _nodes[node].children[index];
+            continue;
+        }
+
+        int child = _nodes.size();
+        _nodes.append(Node{{}, {}, 0, false});
+        _nodes[node].items.insert(index, item);
+        _nodes[node].children.insert(index, child);
+        node = child;
+    }
+
+    if(!_nodes[node].terminal) {
+        _nodes[node].terminal = true;
+        _candidatesCount++;
+    }
+}
+
+
+void CandidateTrie::count(const QVector<int> &transaction, const int weight)
+{
+    countFrom(0, transaction, 0, weight);
+}
+
+
+int CandidateTrie::findChild(const int node, const int item)
+{
+    const QVector<int> &items = _nodes[node].items;
+    auto position = std::lower_bound(items.begin(), items.end(), item);
+    if(position == items.end() || *position != item) {
+        return -1;
+    }
+
+    return _nodes[node].children[position - items.begin()];
+}
+
+
+void CandidateTrie::countFrom(const int node, const QVector<int> &transaction, const int position, const int weight)
+{
+    if(_nodes[node].items.isEmpty()) {
+        return;
+    }
+
+    for(int i = position; i < transaction.size(); i++) {
+        int child = findChild(node, transaction[i]);
+        if(child < 0) {
+            continue;
+        }
+
+        if(_nodes[child].terminal) {
+            _nodes[child].count += weight;
+        }
+        countFrom(child, transaction, i + 1, weight);
+    }
+}
+
+
+void CandidateTrie::collect(const int node, QVector<int> &prefix, QMap<QVector<int>, int> &counts)
+{
+    if(_nodes[node].terminal) {
+        counts[prefix] = _nodes[node].count;
+    }
+
+    for(int i = 0; i < _nodes[node].items.size(); i++) {
+        prefix.append(_nodes[node].items[i]);
+        collect(_nodes[node].children[i], prefix, counts);
+        prefix.removeLast();
+    }
+}
+
+
+int Apriori::minimumCount(const double minSupport, const qint64 transactionsCount)
+{
+    if(transactionsCount <= 0) {
+        return INT_MAX;
+    }
+
+    // Smallest count passing count / transactions >= minSupport in double
+    // arithmetic, so rounding agrees with the ratio tests in the tabs.
+    double transactions = static_cast<double>(transactionsCount);
+    qint64 count = std::max<qint64>(0, static_cast<qint64>(std::ceil(minSupport * transactions)));
+    while(count > 0 && (count - 1) / transactions >= minSupport) {
+        count--;
+    }
+    while(count / transactions < minSupport) {
+        count++;
+    }
+
+    return static_cast<int>(std::min<qint64>(count, INT_MAX));
+}
+
+
+QVector<int> Apriori::uniqueItems(const QVector<int> &transaction)
+{
+    if(std::adjacent_find(transaction.begin(), transaction.end()) == transaction.end()) {
+        return transaction;
+    }
+
+    QVector<int> unique = transaction;
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+    return unique;
+}
+
+
+QMap<QVector<int>, int> Apriori::mine(const QVector<QVector<int>> &transactions, const double minSupport)
+{
+    QMap<QVector<int>, int> frequentItemsets;
+    int minCount = minimumCount(minSupport, transactions.size());
+
+    QMap<int, int> itemCounts;
+    for(const QVector<int> &transaction : transactions) {
+        for(int item : uniqueItems(transaction)) {
+            itemCounts[item]++;
+        }
+    }
+
+    QVector<QVector<int>> level;
+    for(auto it = itemCounts.cbegin(); it != itemCounts.cend(); it++) {
+        if(it.value() >= minCount) {
+            level.append(QVector<int>{it.key()});
+            frequentItemsets[{it.key()}] = it.value();
+        }
+    }
+
+    while(!level.isEmpty()) {
+        TRACE_SCOPE_VALUE("count level", "k", level.first().size() + 1);
+        QVector<QVector<int>> candidates = generateCandidates(level);
+        QMap<QVector<int>, int> counts = countSupports(transactions, candidates);
+
+        level.clear();
+        for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+            if(it.value() >= minCount) {
+                level.append(it.key());
+                frequentItemsets[it.key()] = it.value();
+            }
+        }
+    }
+
+    return frequentItemsets;
+}
+
+
+QMap<QVector<int>, int> Apriori::countSupports(
+    const QVector<QVector<int>> &transactions,
+    const QVector<QVector<int>> &candidates
+)
+{
+    if(candidates.isEmpty()) {
+        return {};
+    }
+
+    CandidateTrie trie;
+    for(const QVector<int> &candidate : candidates) {
+        trie.insert(candidate);
+    }
+
+    for(const QVector<int> &transaction : transactions) {
+        trie.count(uniqueItems(transaction));
+    }
+
+    return trie.getCounts();
+}
+
+
+QVector<QVector<int>> Apriori::generateCandidates(const QVector<QVector<int>> &frequentLevel)
+{
+    QVector<QVector<int>> level = frequentLevel;
+    std::sort(level.begin(), level.end());
+    QSet<QVector<int>> levelSet(level.begin(), level.end());
+
+    QVector<QVector<int>> candidates;
+    for(int i = 0; i < level.size(); i++) {
+        for(int j = i + 1; j < level.size(); j++) {
+            const QVector<int> &a = level[i];
+            const QVector<int> &b = level[j];
+            if(!std::equal(a.begin(), a.end() - 1, b.begin())) {
+                break;
+            }
+
+            QVector<int> candidate = a;
+            candidate.append(b.last());
+
+            bool allSubsetsFrequent = true;
+            for(int removePos = 0; removePos + 2 < candidate.size() && allSubsetsFrequent; removePos++) {
+                QVector<int> subset = candidate;
+                subset.removeAt(removePos);
+                allSubsetsFrequent = levelSet.contains(subset);
+            }
+
+            if(allSubsetsFrequent) {
+                candidates.append(candidate);
+            }
+        }
+    }
+    PROFILE_COUNT("candidates generated", candidates.size());
+
+    return candidates;
+}
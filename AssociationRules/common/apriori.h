@@ -0,0 +1,67 @@
+#ifndef APRIORI_H
+#define APRIORI_H
+
+#include <QVector>
+#include <QMap>
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+
+#include "profiler.h"
+
+
+// Prefix trie over sorted candidate itemsets. Counting walks each transaction
+// once down the trie instead of testing every candidate against it.
+class CandidateTrie
+{
+public:
+    // Constructors
+    CandidateTrie();
+
+    // Getters
+    int getCandidatesCount();
+    QMap<QVector<int>, int> getCounts();
+
+    // Functions
+    void insert(const QVector<int> &itemset);
+    void count(const QVector<int> &transaction, const int weight = 1);
+
+private:
+    struct Node
+    {
+        QVector<int> items;
+        QVector<int> children;
+        int count;
+        bool terminal;
+    };
+
+    // Fields
+    QVector<Node> _nodes;
+    int _candidatesCount;
+
+    // Functions
+    int findChild(const int node, const int item);
+    void countFrom(const int node, const QVector<int> &transaction, const int position, const int weight);
+    void collect(const int node, QVector<int> &prefix, QMap<QVector<int>, int> &counts);
+};
+
+
+// Level-wise frequent itemset mining shared by the out-of-core, sampling and
+// incremental miners. An itemset is frequent when count / transactions is not
+// below minSupport, the same test Grid::generateFrequentItemsets applies.
+class Apriori
+{
+public:
+    static int minimumCount(const double minSupport, const qint64 transactionsCount);
+    static QVector<int> uniqueItems(const QVector<int> &transaction);
+    static QMap<QVector<int>, int> mine(const QVector<QVector<int>> &transactions, const double minSupport);
+    static QMap<QVector<int>, int> countSupports(
+        const QVector<QVector<int>> &transactions,
+        const QVector<QVector<int>> &candidates
+    );
+    static QVector<QVector<int>> generateCandidates(const QVector<QVector<int>> &frequentLevel);
+};
+
+
+#endif // APRIORI_H
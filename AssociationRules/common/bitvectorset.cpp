@@ -0,0 +1,326 @@
+#include "bitvectorset.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BIT_VECTOR_SET_X86
+#include <immintrin.h>
+#endif
+
+
+// Rows shorter than this (in words) gain nothing from the AVX2 lookup.
+static const int avx2MinWords = 16;
+
+
+static int portableXorCount(const quint64 *a, const quint64 *b, const int wordsCount)
+{
+    int count = 0;
+    for(int i = 0; i < wordsCount; i++) {
+        count += static_cast<int>(std::bitset<64>(a[i] ^ b[i]).count());
+    }
+
+    return count;
+}
+
+
+static void portableAndOrCount(const quint64 *a, const quint64 *b, const int wordsCount, int &andCount, int &orCount)
+{
+    andCount = 0;
+    orCount = 0;
+    for(int i = 0; i < wordsCount; i++) {
+        andCount += static_cast<int>(std::bitset<64>(a[i] & b[i]).count());
+        orCount += static_cast<int>(std::bitset<64>(a[i] | b[i]).count());
+    }
+}
+
+
+#ifdef BIT_VECTOR_SET_X86
+__attribute__((target("popcnt")))
+static int popcntXorCount(const quint64 *a, const quint64 *b, const int wordsCount)
+{
+    int count = 0;
+    for(int i = 0; i < wordsCount; i++) {
+        count += __builtin_popcountll(a[i] ^ b[i]);
+    }
+
+    return count;
+}
+
+
+__attribute__((target("popcnt")))
+static void popcntAndOrCount(const quint64 *a, const quint64 *b, const int wordsCount, int &andCount, int &orCount)
+{
+    andCount = 0;
+    orCount = 0;
+    for(int i = 0; i < wordsCount; i++) {
+        andCount += __builtin_popcountll(a[i] & b[i]);
+        orCount += __builtin_popcountll(a[i] | b[i]);
+    }
+}
+
+
+// Bit counts of the 32 bytes of a register, summed into four 64-bit lanes.
+__attribute__((target("avx2")))
+static __m256i avx2Popcount(const __m256i value)
+{
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+    );
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+
+    __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(value, lowMask));
+    __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(value, 4), lowMask));
+
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+
+__attribute__((target("avx2")))
+static int laneSum(const __m256i lanes)
+{
+    return static_cast<int>(_mm256_extract_epi64(lanes, 0) + _mm256_extract_epi64(lanes, 1)
+        + _mm256_extract_epi64(lanes, 2) + _mm256_extract_epi64(lanes, 3));
+}
+
+
+__attribute__((target("avx2,popcnt")))
+static int avx2XorCount(const quint64 *a, const quint64 *b, const int wordsCount)
+{
+    if(wordsCount < avx2MinWords) {
+        return popcntXorCount(a, b, wordsCount);
+    }
+
+    __m256i sum = _mm256_setzero_si256();
+    int i = 0;
+    for(; i + 4 <= wordsCount; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        sum = _mm256_add_epi64(sum, avx2Popcount(_mm256_xor_si256(x, y)));
+    }
+
+    return laneSum(sum) + popcntXorCount(a + i, b + i, wordsCount - i);
+}
+
+
+__attribute__((target("avx2,popcnt")))
+static void avx2AndOrCount(const quint64 *a, const quint64 *b, const int wordsCount, int &andCount, int &orCount)
+{
+    if(wordsCount < avx2MinWords) {
+        popcntAndOrCount(a, b, wordsCount, andCount, orCount);
+        return;
+    }
+
+    __m256i andSum = _mm256_setzero_si256();
+    __m256i orSum = _mm256_setzero_si256();
+    int i = 0;
+    for(; i + 4 <= wordsCount; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        andSum = _mm256_add_epi64(andSum, avx2Popcount(_mm256_and_si256(x, y)));
+        orSum = _mm256_add_epi64(orSum, avx2Popcount(_mm256_or_si256(x, y)));
+    }
+
+    popcntAndOrCount(a + i, b + i, wordsCount - i, andCount, orCount);
+    andCount += laneSum(andSum);
+    orCount += laneSum(orSum);
+}
+
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static int avx512XorCount(const quint64 *a, const quint64 *b, const int wordsCount)
+{
+    __m512i sum = _mm512_setzero_si512();
+    for(int i = 0; i < wordsCount; i += 8) {
+        __mmask8 mask = wordsCount - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (wordsCount - i)) - 1);
+        __m512i x = _mm512_maskz_loadu_epi64(mask, a + i);
+        __m512i y = _mm512_maskz_loadu_epi64(mask, b + i);
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_xor_si512(x, y)));
+    }
+
+    return static_cast<int>(_mm512_reduce_add_epi64(sum));
+}
+
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static void avx512AndOrCount(const quint64 *a, const quint64 *b, const int wordsCount, int &andCount, int &orCount)
+{
+    __m512i andSum = _mm512_setzero_si512();
+    __m512i orSum = _mm512_setzero_si512();
+    for(int i = 0; i < wordsCount; i += 8) {
+        __mmask8 mask = wordsCount - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (wordsCount - i)) - 1);
+        __m512i x = _mm512_maskz_loadu_epi64(mask, a + i);
+        __m512i y = _mm512_maskz_loadu_epi64(mask, b + i);
+        andSum = _mm512_add_epi64(andSum, _mm512_popcnt_epi64(_mm512_and_si512(x, y)));
+        orSum = _mm512_add_epi64(orSum, _mm512_popcnt_epi64(_mm512_or_si512(x, y)));
+    }
+
+    andCount = static_cast<int>(_mm512_reduce_add_epi64(andSum));
+    orCount = static_cast<int>(_mm512_reduce_add_epi64(orSum));
+}
+#endif
+
+
+BitVectorSet::BitVectorSet()
+{
+    _rowsCount = 0;
+    _dimension = 0;
+    _wordsCount = 0;
+}
+
+
+int BitVectorSet::getRowsCount() const
+{
+    return _rowsCount;
+}
+
+
+int BitVectorSet::getDimension() const
+{
+    return _dimension;
+}
+
+
+int BitVectorSet::getWordsCount() const
+{
+    return _wordsCount;
+}
+
+
+const quint64 *BitVectorSet::getRow(const int row) const
+{
+    return _words.data() + static_cast<size_t>(row) * _wordsCount;
+}
+
+
+QString BitVectorSet::getErrorString() const
+{
+    return _errorString;
+}
+
+
+QString BitVectorSet::getInstructionSet()
+{
+    return kernels().instructionSet;
+}
+
+
+bool BitVectorSet::load(const QString &filePath)
+{
+    _rowsCount = 0;
+    _dimension = 0;
+    _wordsCount = 0;
+    _words.clear();
+    _errorString.clear();
+
+    VectorReader reader(filePath);
+    if(!reader.open()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    QVector<double> vector;
+    while(reader.next(vector)) {
+        if(_rowsCount > 0 && vector.size() != _dimension) {
+            _errorString = QString("Line %1: %2 values, expected %3").arg(reader.getLineNumber()).arg(vector.size()).arg(_dimension);
+            return false;
+        }
+        if(!append(vector)) {
+            _errorString = QString("Line %1: vectors value must be 1 or 0").arg(reader.getLineNumber());
+            return false;
+        }
+    }
+
+    if(reader.hasError()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    if(_rowsCount == 0) {
+        _errorString = filePath + " holds no vectors";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool BitVectorSet::append(const QVector<double> &vector)
+{
+    if(_rowsCount == 0) {
+        _dimension = vector.size();
+        _wordsCount = (_dimension + 63) / 64;
+    } else if(vector.size() != _dimension) {
+        return false;
+    }
+
+    size_t begin = _words.size();
+    _words.resize(begin + _wordsCount, 0);
+    for(int i = 0; i < vector.size(); i++) {
+        if(vector[i] == 1) {
+            _words[begin + i / 64] |= quint64(1) << (i % 64);
+        } else if(vector[i] != 0) {
+            _words.resize(begin);
+            return false;
+        }
+    }
+    _rowsCount++;
+
+    return true;
+}
+
+
+void BitVectorSet::hammingDistances(const quint64 *query, const int firstRow, const int lastRow, double *distances) const
+{
+    XorKernel xorCount = kernels().xorCount;
+    for(int row = firstRow; row < lastRow; row++) {
+        distances[row] = xorCount(query, getRow(row), _wordsCount);
+    }
+}
+
+
+void BitVectorSet::jaccardCoefficients(const quint64 *query, const int firstRow, const int lastRow, double *coefficients) const
+{
+    AndOrKernel andOrCount = kernels().andOrCount;
+    for(int row = firstRow; row < lastRow; row++) {
+        int andCount;
+        int orCount;
+        andOrCount(query, getRow(row), _wordsCount, andCount, orCount);
+        coefficients[row] = orCount == 0 ? 0.0 : static_cast<double>(andCount) / orCount;
+    }
+}
+
+
+int BitVectorSet::hammingDistance(const quint64 *a, const quint64 *b, const int wordsCount)
+{
+    return kernels().xorCount(a, b, wordsCount);
+}
+
+
+double BitVectorSet::jaccardCoefficient(const quint64 *a, const quint64 *b, const int wordsCount)
+{
+    int andCount;
+    int orCount;
+    kernels().andOrCount(a, b, wordsCount, andCount, orCount);
+
+    return orCount == 0 ? 0.0 : static_cast<double>(andCount) / orCount;
+}
+
+
+const BitVectorSet::Kernels &BitVectorSet::kernels()
+{
+    static const Kernels selected = []() {
+        Kernels kernels = {portableXorCount, portableAndOrCount, "portable"};
+#ifdef BIT_VECTOR_SET_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512vpopcntdq")) {
+            kernels = {avx512XorCount, avx512AndOrCount, "AVX-512 VPOPCNTDQ"};
+        } else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+            kernels = {avx2XorCount, avx2AndOrCount, "AVX2"};
+        } else if(__builtin_cpu_supports("popcnt")) {
+            kernels = {popcntXorCount, popcntAndOrCount, "POPCNT"};
+        }
+#endif
+        return kernels;
+    }();
+
+    return selected;
+}
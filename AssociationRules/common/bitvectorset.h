@@ -0,0 +1,70 @@
+#ifndef BITVECTORSET_H
+#define BITVECTORSET_H
+
+#include <QString>
+#include <QVector>
+
+#include <bitset>
+#include <vector>
+
+#include "vectorreader.h"
+
+
+// A set of equally long 0/1 vectors packed into 64-bit words, row by row in
+// one contiguous block: bit j of a row is bit j % 64 of word j / 64, unused
+// bits of the last word stay zero. Hamming distance is the popcount of the
+// XOR of two rows and the Jaccard coefficient is popcount(AND) divided by
+// popcount(OR), so comparing two vectors touches one bit per value instead
+// of a double.
+//
+// The popcount kernels use AVX-512 VPOPCNTDQ, AVX2 (nibble lookup, for long
+// rows) or the POPCNT instruction, whichever the CPU has, and a portable
+// loop otherwise. hammingDistances() and jaccardCoefficients() compare one
+// query against the rows firstRow .. lastRow - 1 and store the value for
+// row i at index i of the output.
+class BitVectorSet
+{
+public:
+    // Constructors
+    BitVectorSet();
+
+    // Getters
+    int getRowsCount() const;
+    int getDimension() const;
+    int getWordsCount() const;
+    const quint64 *getRow(const int row) const;
+    QString getErrorString() const;
+    static QString getInstructionSet();
+
+    // Functions
+    bool load(const QString &filePath);
+    bool append(const QVector<double> &vector);
+    void hammingDistances(const quint64 *query, const int firstRow, const int lastRow, double *distances) const;
+    void jaccardCoefficients(const quint64 *query, const int firstRow, const int lastRow, double *coefficients) const;
+    static int hammingDistance(const quint64 *a, const quint64 *b, const int wordsCount);
+    static double jaccardCoefficient(const quint64 *a, const quint64 *b, const int wordsCount);
+
+private:
+    typedef int (*XorKernel)(const quint64 *a, const quint64 *b, const int wordsCount);
+    typedef void (*AndOrKernel)(const quint64 *a, const quint64 *b, const int wordsCount, int &andCount, int &orCount);
+
+    struct Kernels
+    {
+        XorKernel xorCount;
+        AndOrKernel andOrCount;
+        QString instructionSet;
+    };
+
+    // Fields
+    int _rowsCount;
+    int _dimension;
+    int _wordsCount;
+    std::vector<quint64> _words;
+    QString _errorString;
+
+    // Functions
+    static const Kernels &kernels();
+};
+
+
+#endif // BITVECTORSET_H
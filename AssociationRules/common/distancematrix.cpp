@@ -0,0 +1,365 @@
+#include "distancematrix.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DISTANCE_MATRIX_X86
+#include <immintrin.h>
+#endif
+
+
+// Rows per band: one band of results is kept in memory at a time.
+static const int bandRows = 64;
+// Column vectors of one tile are sized to stay in a typical L2 cache.
+static const int tileBytes = 256 * 1024;
+
+
+static double scalarDot(const double *a, const double *b, const int length)
+{
+    double sums[4] = {0, 0, 0, 0};
+    for(int i = 0; i < length; i += 4) {
+        sums[0] += a[i] * b[i];
+        sums[1] += a[i + 1] * b[i + 1];
+        sums[2] += a[i + 2] * b[i + 2];
+        sums[3] += a[i + 3] * b[i + 3];
+    }
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+
+static double scalarSquared(const double *a, const double *b, const int length)
+{
+    double sums[4] = {0, 0, 0, 0};
+    for(int i = 0; i < length; i += 4) {
+        for(int j = 0; j < 4; j++) {
+            double difference = a[i + j] - b[i + j];
+            sums[j] += difference * difference;
+        }
+    }
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+
+static double scalarManhattan(const double *a, const double *b, const int length)
+{
+    double sums[4] = {0, 0, 0, 0};
+    for(int i = 0; i < length; i += 4) {
+        for(int j = 0; j < 4; j++) {
+            sums[j] += std::abs(a[i + j] - b[i + j]);
+        }
+    }
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+
+#ifdef DISTANCE_MATRIX_X86
+__attribute__((target("avx2,fma")))
+static double horizontalSum(const __m256d sum)
+{
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+
+__attribute__((target("avx2,fma")))
+static double avx2Dot(const double *a, const double *b, const int length)
+{
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    for(int i = 0; i < length; i += 8) {
+        sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), sum0);
+        sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), sum1);
+    }
+
+    return horizontalSum(_mm256_add_pd(sum0, sum1));
+}
+
+
+__attribute__((target("avx2,fma")))
+static double avx2Squared(const double *a, const double *b, const int length)
+{
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    for(int i = 0; i < length; i += 8) {
+        __m256d difference0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        __m256d difference1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+        sum0 = _mm256_fmadd_pd(difference0, difference0, sum0);
+        sum1 = _mm256_fmadd_pd(difference1, difference1, sum1);
+    }
+
+    return horizontalSum(_mm256_add_pd(sum0, sum1));
+}
+
+
+__attribute__((target("avx2,fma")))
+static double avx2Manhattan(const double *a, const double *b, const int length)
+{
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    for(int i = 0; i < length; i += 8) {
+        __m256d difference0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        __m256d difference1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+        sum0 = _mm256_add_pd(sum0, _mm256_andnot_pd(signMask, difference0));
+        sum1 = _mm256_add_pd(sum1, _mm256_andnot_pd(signMask, difference1));
+    }
+
+    return horizontalSum(_mm256_add_pd(sum0, sum1));
+}
+
+
+__attribute__((target("avx512f")))
+static double avx512Dot(const double *a, const double *b, const int length)
+{
+    __m512d sum = _mm512_setzero_pd();
+    for(int i = 0; i < length; i += 8) {
+        sum = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), sum);
+    }
+
+    return _mm512_reduce_add_pd(sum);
+}
+
+
+__attribute__((target("avx512f")))
+static double avx512Squared(const double *a, const double *b, const int length)
+{
+    __m512d sum = _mm512_setzero_pd();
+    for(int i = 0; i < length; i += 8) {
+        __m512d difference = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+        sum = _mm512_fmadd_pd(difference, difference, sum);
+    }
+
+    return _mm512_reduce_add_pd(sum);
+}
+
+
+__attribute__((target("avx512f")))
+static double avx512Manhattan(const double *a, const double *b, const int length)
+{
+    __m512d sum = _mm512_setzero_pd();
+    for(int i = 0; i < length; i += 8) {
+        sum = _mm512_add_pd(sum, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i))));
+    }
+
+    return _mm512_reduce_add_pd(sum);
+}
+#endif
+
+
+DistanceMatrix::DistanceMatrix(const Metric metric, const double p, const int threadsCount)
+{
+    _metric = metric;
+    _p = p;
+    _threadsCount = threadsCount > 0 ? threadsCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    _dimension = 0;
+
+    _dotKernel = scalarDot;
+    _squaredKernel = scalarSquared;
+    _manhattanKernel = scalarManhattan;
+    _instructionSet = "scalar";
+
+#ifdef DISTANCE_MATRIX_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) {
+        _dotKernel = avx512Dot;
+        _squaredKernel = avx512Squared;
+        _manhattanKernel = avx512Manhattan;
+        _instructionSet = "AVX-512";
+    } else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        _dotKernel = avx2Dot;
+        _squaredKernel = avx2Squared;
+        _manhattanKernel = avx2Manhattan;
+        _instructionSet = "AVX2";
+    }
+#endif
+}
+
+
+QString DistanceMatrix::getInstructionSet()
+{
+    return _instructionSet;
+}
+
+
+int DistanceMatrix::getThreadsCount()
+{
+    return _threadsCount;
+}
+
+
+bool DistanceMatrix::compute(const VectorSet &rows, const VectorSet &columns, const RowsWriter &writer)
+{
+    return run(rows, columns, false, writer);
+}
+
+
+bool DistanceMatrix::computePairs(const VectorSet &vectors, const RowsWriter &writer)
+{
+    return run(vectors, vectors, true, writer);
+}
+
+
+bool DistanceMatrix::compute(const BitVectorSet &rows, const BitVectorSet &columns, const RowsWriter &writer)
+{
+    return run(rows, columns, false, writer);
+}
+
+
+bool DistanceMatrix::computePairs(const BitVectorSet &vectors, const RowsWriter &writer)
+{
+    return run(vectors, vectors, true, writer);
+}
+
+
+bool DistanceMatrix::run(
+    const VectorSet &rows,
+    const VectorSet &columns,
+    const bool pairs,
+    const RowsWriter &writer
+)
+{
+    // Hamming and Jaccard run on BitVectorSet only.
+    if(_metric == Hamming || _metric == Jaccard) {
+        return false;
+    }
+
+    _dimension = rows.getDimension();
+    _rowTerms = rowTerms(rows);
+    _columnTerms = pairs ? _rowTerms : rowTerms(columns);
+
+    int stride = rows.getStride();
+    auto rowTile = [&](const int row, const int firstColumn, const int lastColumn, double *distances) {
+        const double *a = rows.getRow(row);
+        for(int column = firstColumn; column < lastColumn; column++) {
+            distances[column] = pairDistance(a, columns.getRow(column), stride, _rowTerms[row], _columnTerms[column]);
+        }
+    };
+
+    return runBands(rows.getRowsCount(), columns.getRowsCount(), 8 * stride, pairs, rowTile, writer);
+}
+
+
+bool DistanceMatrix::run(
+    const BitVectorSet &rows,
+    const BitVectorSet &columns,
+    const bool pairs,
+    const RowsWriter &writer
+)
+{
+    bool hamming = _metric == Hamming;
+    auto rowTile = [&](const int row, const int firstColumn, const int lastColumn, double *distances) {
+        if(hamming) {
+            columns.hammingDistances(rows.getRow(row), firstColumn, lastColumn, distances);
+        } else {
+            columns.jaccardCoefficients(rows.getRow(row), firstColumn, lastColumn, distances);
+        }
+    };
+
+    return runBands(rows.getRowsCount(), columns.getRowsCount(), 8 * rows.getWordsCount(), pairs, rowTile, writer);
+}
+
+
+bool DistanceMatrix::runBands(
+    const int rowsCount,
+    const int columnsCount,
+    const int columnBytes,
+    const bool pairs,
+    const RowTile &rowTile,
+    const RowsWriter &writer
+)
+{
+    int tileColumns = std::clamp(tileBytes / std::max(1, columnBytes), 16, 4096);
+
+    std::vector<double> values;
+    for(int firstRow = 0; firstRow < rowsCount; firstRow += bandRows) {
+        int bandCount = std::min(bandRows, rowsCount - firstRow);
+        values.resize(static_cast<size_t>(bandCount) * columnsCount);
+
+        // In pair mode only the columns after the band's first row are needed.
+        int firstColumn = pairs ? firstRow + 1 : 0;
+        int tilesCount = std::max(0, (columnsCount - firstColumn + tileColumns - 1) / tileColumns);
+
+        std::atomic<int> nextTile(0);
+        auto work = [&]() {
+            for(int tile = nextTile++; tile < tilesCount; tile = nextTile++) {
+                int begin = firstColumn + tile * tileColumns;
+                int end = std::min(begin + tileColumns, columnsCount);
+                for(int row = firstRow; row < firstRow + bandCount; row++) {
+                    double *distances = values.data() + static_cast<size_t>(row - firstRow) * columnsCount;
+                    int rowBegin = pairs ? std::max(begin, row + 1) : begin;
+                    if(rowBegin < end) {
+                        rowTile(row, rowBegin, end, distances);
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(int thread = 1; thread < std::min(_threadsCount, tilesCount); thread++) {
+            threads.emplace_back(work);
+        }
+        work();
+        for(std::thread &thread : threads) {
+            thread.join();
+        }
+
+        if(!writer(firstRow, bandCount, columnsCount, values)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+double DistanceMatrix::pairDistance(const double *a, const double *b, const int length, const double rowTerm, const double columnTerm)
+{
+    switch(_metric) {
+    case Mahalanobis:
+        return std::sqrt(_squaredKernel(a, b, length));
+    case Minkowski: {
+        if(_p == 2) {
+            return std::sqrt(_squaredKernel(a, b, length));
+        }
+        if(_p == 1) {
+            return _manhattanKernel(a, b, length);
+        }
+
+        double sum = 0;
+        for(int i = 0; i < _dimension; i++) {
+            sum += std::pow(std::abs(a[i] - b[i]), _p);
+        }
+        return std::pow(sum, 1.0 / _p);
+    }
+    case Cosine: {
+        if(qFuzzyIsNull(rowTerm) || qFuzzyIsNull(columnTerm)) {
+            return 0;
+        }
+        return std::clamp(_dotKernel(a, b, length) / (rowTerm * columnTerm), -1.0, 1.0);
+    }
+    case Hamming:
+    case Jaccard:
+        // Packed bits only, run() rejects them on dense vectors.
+        break;
+    }
+
+    return 0;
+}
+
+
+std::vector<double> DistanceMatrix::rowTerms(const VectorSet &vectors)
+{
+    // Only Cosine needs a per-row term, the norm.
+    std::vector<double> terms(vectors.getRowsCount(), 0.0);
+    if(_metric != Cosine) {
+        return terms;
+    }
+
+    for(int row = 0; row < vectors.getRowsCount(); row++) {
+        terms[row] = std::sqrt(_dotKernel(vectors.getRow(row), vectors.getRow(row), vectors.getStride()));
+    }
+
+    return terms;
+}
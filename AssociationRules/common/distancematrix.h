@@ -0,0 +1,111 @@
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+#include <QString>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "vectorset.h"
+#include "bitvectorset.h"
+
+
+// Many-vs-many distance engine behind the Distance tab's batch mode. The
+// result is produced in bands of rows, each band split into tiles whose
+// column vectors fit in the L2 cache, so every loaded column is reused by
+// all rows of the band. Tiles of a band are spread over worker threads and
+// each finished band is handed to the writer, so the full matrix never has
+// to fit in memory.
+//
+// The inner products run through AVX-512 or AVX2/FMA kernels when the CPU
+// has them (checked at run time), and through a scalar kernel otherwise.
+// Cosine reduces to one dot product per pair plus per-row norms computed
+// once; Minkowski uses dedicated kernels for p = 1 and p = 2 and a scalar
+// loop for any other p.
+//
+// Mahalanobis expects vectors already whitened by Mahalanobis::whiten(), on
+// which it is the Euclidean distance.
+//
+// Hamming and Jaccard take packed 0/1 vectors (BitVectorSet) through the same
+// band and tile path with popcount kernels; compute() on a VectorSet returns
+// false for them.
+//
+// Values match the single pair functions of the tab: Cosine gives the
+// similarity and Jaccard the coefficient.
+class DistanceMatrix
+{
+public:
+    enum Metric
+    {
+        Minkowski,
+        Cosine,
+        Hamming,
+        Jaccard,
+        Mahalanobis
+    };
+
+    // Receives rowsCount rows starting at firstRow, each columnsCount values
+    // wide. In pair mode row i only holds valid values after column i.
+    typedef std::function<bool(const int firstRow, const int rowsCount, const int columnsCount, const std::vector<double> &values)> RowsWriter;
+
+    // Constructors
+    DistanceMatrix(const Metric metric, const double p = 2, const int threadsCount = 0);
+
+    // Getters
+    QString getInstructionSet();
+    int getThreadsCount();
+
+    // Functions
+    bool compute(const VectorSet &rows, const VectorSet &columns, const RowsWriter &writer);
+    bool computePairs(const VectorSet &vectors, const RowsWriter &writer);
+    bool compute(const BitVectorSet &rows, const BitVectorSet &columns, const RowsWriter &writer);
+    bool computePairs(const BitVectorSet &vectors, const RowsWriter &writer);
+
+private:
+    typedef double (*Kernel)(const double *a, const double *b, const int length);
+    // Fills distances[column] for one row and the columns of one tile.
+    typedef std::function<void(const int row, const int firstColumn, const int lastColumn, double *distances)> RowTile;
+
+    // Fields
+    Metric _metric;
+    double _p;
+    int _threadsCount;
+    int _dimension;
+    Kernel _dotKernel;
+    Kernel _squaredKernel;
+    Kernel _manhattanKernel;
+    QString _instructionSet;
+    std::vector<double> _rowTerms;
+    std::vector<double> _columnTerms;
+
+    // Functions
+    bool run(
+        const VectorSet &rows,
+        const VectorSet &columns,
+        const bool pairs,
+        const RowsWriter &writer
+    );
+    bool run(
+        const BitVectorSet &rows,
+        const BitVectorSet &columns,
+        const bool pairs,
+        const RowsWriter &writer
+    );
+    bool runBands(
+        const int rowsCount,
+        const int columnsCount,
+        const int columnBytes,
+        const bool pairs,
+        const RowTile &rowTile,
+        const RowsWriter &writer
+    );
+    double pairDistance(const double *a, const double *b, const int length, const double rowTerm, const double columnTerm);
+    std::vector<double> rowTerms(const VectorSet &vectors);
+};
+
+
+#endif // DISTANCEMATRIX_H
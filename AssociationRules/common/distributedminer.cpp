@@ -0,0 +1,332 @@
+#include "distributedminer.h"
+
+#include <limits>
+
+
+DistributedMiner::DistributedMiner(const QString &filePath, const int workersCount, const qint64 memoryBudget)
+{
+    _filePath = filePath;
+    _workersCount = std::max(1, workersCount);
+    _memoryBudget = memoryBudget;
+    _transactionsCount = 0;
+    _candidatesCount = 0;
+}
+
+
+int DistributedMiner::getTransactionsCount()
+{
+    return _transactionsCount;
+}
+
+
+int DistributedMiner::getCandidatesCount()
+{
+    return _candidatesCount;
+}
+
+
+QString DistributedMiner::getErrorString()
+{
+    return _errorString;
+}
+
+
+bool DistributedMiner::mine(const double minSupport, QMap<QVector<int>, int> &frequentItemsets)
+{
+    PROFILE_SCOPE("mine");
+
+    frequentItemsets.clear();
+    _transactionsCount = 0;
+    _candidatesCount = 0;
+
+    if(!QFileInfo(_filePath).exists()) {
+        _errorString = "Unable to open the input file";
+        return false;
+    }
+
+    // Map 1: local frequent itemsets of every range.
+    QVector<QByteArray> outputs;
+    QStringList mineArguments = {
+        "--mode", "mine",
+        "--min-support", QString::number(minSupport, 'g', 17),
+        "--memory-budget", QString::number(_memoryBudget)
+    };
+    if(!runWorkers(mineArguments, QByteArray(), outputs)) {
+        return false;
+    }
+
+    QSet<QVector<int>> candidates;
+    for(const QByteArray &output : outputs) {
+        QList<QByteArray> lines = output.split('\n');
+        int rangeTransactions = 0;
+        if(!readTransactionsCount(lines.value(0), rangeTransactions)) {
+            return false;
+        }
+        _transactionsCount += rangeTransactions;
+
+        for(int i = 1; i < lines.size(); i++) {
+            if(!lines[i].isEmpty()) {
+                candidates.insert(parseItems(lines[i], 0));
+            }
+        }
+    }
+    _candidatesCount = candidates.size();
+
+    if(candidates.isEmpty()) {
+        return true;
+    }
+
+    // Map 2: every range counts the candidate union; reduce sums the counts.
+    QByteArray candidateLines;
+    for(const QVector<int> &candidate : candidates) {
+        candidateLines += formatItems(candidate) + '\n';
+    }
+
+    if(!runWorkers({"--mode", "count"}, candidateLines, outputs)) {
+        return false;
+    }
+
+    QMap<QVector<int>, int> counts;
+    for(const QByteArray &output : outputs) {
+        QList<QByteArray> lines = output.split('\n');
+        for(int i = 1; i < lines.size(); i++) {
+            if(lines[i].isEmpty()) {
+                continue;
+            }
+
+            int separator = lines[i].indexOf(' ');
+            counts[parseItems(lines[i], separator + 1)] += lines[i].left(separator).toInt();
+        }
+    }
+
+    int minCount = Apriori::minimumCount(minSupport, _transactionsCount);
+    for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+        if(it.value() >= minCount) {
+            frequentItemsets[it.key()] = it.value();
+        }
+    }
+
+    return true;
+}
+
+
+int DistributedMiner::mineRange(
+    const QString &filePath,
+    const qint64 begin,
+    const qint64 end,
+    const double minSupport,
+    const qint64 memoryBudget
+)
+{
+    QTextStream err(stderr);
+
+    PartitionMiner miner(filePath, memoryBudget > 0 ? memoryBudget : std::numeric_limits<qint64>::max());
+    miner.setRange(begin, end);
+
+    QMap<QVector<int>, int> frequentItemsets;
+    if(!miner.mine(minSupport, frequentItemsets)) {
+        err << miner.getErrorString() << "\n";
+        return 1;
+    }
+
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+    out.write("transactions " + QByteArray::number(miner.getTransactionsCount()) + "\n");
+    for(auto it = frequentItemsets.cbegin(); it != frequentItemsets.cend(); it++) {
+        out.write(formatItems(it.key()) + "\n");
+    }
+    out.close();
+
+    return 0;
+}
+
+
+int DistributedMiner::countRange(const QString &filePath, const qint64 begin, const qint64 end)
+{
+    QTextStream err(stderr);
+
+    QFile in;
+    in.open(stdin, QIODevice::ReadOnly);
+    QList<QByteArray> lines = in.readAll().split('\n');
+    in.close();
+
+    CandidateTrie trie;
+    for(const QByteArray &line : lines) {
+        if(!line.isEmpty()) {
+            trie.insert(parseItems(line, 0));
+        }
+    }
+
+    TransactionReader reader(filePath);
+    reader.setRange(begin, end);
+    if(!reader.open()) {
+        err << reader.getErrorString() << "\n";
+        return 1;
+    }
+
+    int transactionsCount = 0;
+    QVector<int> transaction;
+    while(reader.next(transaction)) {
+        trie.count(Apriori::uniqueItems(transaction));
+        transactionsCount++;
+    }
+    if(reader.hasError()) {
+        err << reader.getErrorString() << "\n";
+        return 1;
+    }
+
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+    out.write("transactions " + QByteArray::number(transactionsCount) + "\n");
+    QMap<QVector<int>, int> counts = trie.getCounts();
+    for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+        out.write(QByteArray::number(it.value()) + " " + formatItems(it.key()) + "\n");
+    }
+    out.close();
+
+    return 0;
+}
+
+
+QVector<QPair<qint64, qint64>> DistributedMiner::splitRanges()
+{
+    // Workers realign the boundaries to line starts themselves.
+    qint64 fileSize = QFileInfo(_filePath).size();
+    QVector<QPair<qint64, qint64>> ranges;
+    for(int i = 0; i < _workersCount; i++) {
+        qint64 begin = fileSize * i / _workersCount;
+        qint64 end = (i == _workersCount - 1) ? -1 : fileSize * (i + 1) / _workersCount;
+        ranges.append(qMakePair(begin, end));
+    }
+
+    return ranges;
+}
+
+
+bool DistributedMiner::runWorkers(
+    const QStringList &arguments,
+    const QByteArray &input,
+    QVector<QByteArray> &outputs
+)
+{
+    QVector<QPair<qint64, qint64>> ranges = splitRanges();
+    outputs = QVector<QByteArray>(ranges.size());
+
+    // All workers are served from one event loop, so every stdin is written
+    // and every stdout drained at the same time. Waiting on one QProcess at
+    // a time would only feed the pipes of that one and run the workers in
+    // turn.
+    QEventLoop loop;
+    QVector<QProcess*> workers;
+    int runningCount = ranges.size();
+    bool success = true;
+
+    auto fail = [&](const QString &errorString) {
+        if(success) {
+            _errorString = errorString;
+            success = false;
+        }
+        for(QProcess *worker : workers) {
+            if(worker->state() != QProcess::NotRunning) {
+                worker->kill();
+            }
+        }
+    };
+    auto stop = [&]() {
+        runningCount--;
+        if(runningCount == 0) {
+            loop.quit();
+        }
+    };
+
+    for(int i = 0; i < ranges.size(); i++) {
+        QStringList workerArguments = {
+            "worker",
+            "--input", _filePath,
+            "--begin", QString::number(ranges[i].first),
+            "--end", QString::number(ranges[i].second)
+        };
+        workerArguments += arguments;
+
+        QProcess *worker = new QProcess();
+        workers.append(worker);
+
+        QObject::connect(worker, &QProcess::started, [worker, &input]() {
+            if(!input.isEmpty()) {
+                worker->write(input);
+            }
+            worker->closeWriteChannel();
+        });
+        QObject::connect(worker, &QProcess::readyReadStandardOutput, [worker, &outputs, i]() {
+            outputs[i] += worker->readAllStandardOutput();
+        });
+        QObject::connect(worker, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            [&, worker, i](const int exitCode, const QProcess::ExitStatus exitStatus) {
+                outputs[i] += worker->readAllStandardOutput();
+                if(exitStatus != QProcess::NormalExit || exitCode != 0) {
+                    QString workerError = QString::fromLocal8Bit(worker->readAllStandardError()).trimmed();
+                    fail(workerError.isEmpty() ? "A worker process failed" : workerError);
+                }
+                stop();
+            }
+        );
+        QObject::connect(worker, &QProcess::errorOccurred, [&](const QProcess::ProcessError error) {
+            // A worker that never started emits no finished signal.
+            if(error == QProcess::FailedToStart) {
+                fail("Unable to start a worker process");
+                stop();
+            }
+        });
+
+        worker->start(QCoreApplication::applicationFilePath(), workerArguments);
+    }
+
+    if(runningCount > 0) {
+        loop.exec();
+    }
+
+    qDeleteAll(workers);
+
+    return success;
+}
+
+
+bool DistributedMiner::readTransactionsCount(const QByteArray &line, int &transactionsCount)
+{
+    QList<QByteArray> parts = line.split(' ');
+    bool success = parts.size() == 2 && parts[0] == "transactions";
+    transactionsCount = success ? parts[1].toInt(&success) : 0;
+
+    if(!success) {
+        _errorString = "Invalid response from a worker process";
+    }
+
+    return success;
+}
+
+
+QVector<int> DistributedMiner::parseItems(const QByteArray &line, const int from)
+{
+    QVector<int> itemset;
+    for(const QByteArray &item : line.mid(from).split(' ')) {
+        if(!item.isEmpty()) {
+            itemset.append(item.toInt());
+        }
+    }
+
+    return itemset;
+}
+
+
+QByteArray DistributedMiner::formatItems(const QVector<int> &itemset)
+{
+    QByteArray line;
+    for(int item : itemset) {
+        if(!line.isEmpty()) {
+            line += ' ';
+        }
+        line += QByteArray::number(item);
+    }
+
+    return line;
+}
@@ -0,0 +1,80 @@
+#ifndef DISTRIBUTEDMINER_H
+#define DISTRIBUTEDMINER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QSet>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTextStream>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QtAlgorithms>
+
+#include "apriori.h"
+#include "partitionminer.h"
+#include "transactionreader.h"
+#include "profiler.h"
+
+
+// Coordinator for SON mining across worker processes. The input is split
+// into byte ranges and every range is handed to a "worker" instance of this
+// executable over its standard streams:
+//
+//   mine   the worker mines its range at the relative support and prints
+//          "transactions <n>" followed by one local frequent itemset per line
+//   count  the worker reads candidate itemsets from stdin until EOF and
+//          prints "transactions <n>" followed by "<count> <items>" lines
+//
+// The coordinator unions the mined candidates, sums the counted supports and
+// applies the global threshold, so the result equals a single process run.
+class DistributedMiner
+{
+public:
+    // Constructors
+    DistributedMiner(const QString &filePath, const int workersCount, const qint64 memoryBudget);
+
+    // Getters
+    int getTransactionsCount();
+    int getCandidatesCount();
+    QString getErrorString();
+
+    // Functions
+    bool mine(const double minSupport, QMap<QVector<int>, int> &frequentItemsets);
+
+    // Worker side
+    static int mineRange(
+        const QString &filePath,
+        const qint64 begin,
+        const qint64 end,
+        const double minSupport,
+        const qint64 memoryBudget
+    );
+    static int countRange(const QString &filePath, const qint64 begin, const qint64 end);
+
+private:
+    // Fields
+    QString _filePath;
+    int _workersCount;
+    qint64 _memoryBudget;
+    int _transactionsCount;
+    int _candidatesCount;
+    QString _errorString;
+
+    // Functions
+    QVector<QPair<qint64, qint64>> splitRanges();
+    bool runWorkers(
+        const QStringList &arguments,
+        const QByteArray &input,
+        QVector<QByteArray> &outputs
+    );
+    bool readTransactionsCount(const QByteArray &line, int &transactionsCount);
+    static QVector<int> parseItems(const QByteArray &line, const int from);
+    static QByteArray formatItems(const QVector<int> &itemset);
+};
+
+
+#endif // DISTRIBUTEDMINER_H
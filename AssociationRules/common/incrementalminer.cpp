@@ -0,0 +1,344 @@
+#include "incrementalminer.h"
+
+
+static const qint64 checksumWindow = 4096;
+
+
+IncrementalMiner::IncrementalMiner(const QString &filePath, const QString &statePath)
+{
+    _filePath = filePath;
+    _statePath = statePath;
+    _minedSize = 0;
+    _minedTransactionsCount = 0;
+    _transactionsCount = 0;
+    _appendedTransactionsCount = 0;
+    _rescannedCount = 0;
+    _incremental = false;
+}
+
+
+int IncrementalMiner::getTransactionsCount()
+{
+    return _transactionsCount;
+}
+
+
+int IncrementalMiner::getAppendedTransactionsCount()
+{
+    return _appendedTransactionsCount;
+}
+
+
+int IncrementalMiner::getRescannedCount()
+{
+    return _rescannedCount;
+}
+
+
+bool IncrementalMiner::isIncremental()
+{
+    return _incremental;
+}
+
+
+QString IncrementalMiner::getErrorString()
+{
+    return _errorString;
+}
+
+
+bool IncrementalMiner::mine(const double minSupport, QMap<QVector<int>, int> &frequentItemsets)
+{
+    PROFILE_SCOPE("mine");
+
+    frequentItemsets.clear();
+    _transactionsCount = 0;
+    _appendedTransactionsCount = 0;
+    _rescannedCount = 0;
+    _errorString.clear();
+
+    QFileInfo fileInfo(_filePath);
+    if(!fileInfo.exists()) {
+        _errorString = "Unable to open the input file";
+        return false;
+    }
+    qint64 fileSize = fileInfo.size();
+
+    _incremental = loadState(minSupport, fileSize);
+    if(!_incremental) {
+        _minedSize = 0;
+        _minedTransactionsCount = 0;
+        _supports.clear();
+    }
+
+    // Everything missing from the previous result was below its threshold.
+    int unknownBound = _minedTransactionsCount > 0 ? Apriori::minimumCount(minSupport, _minedTransactionsCount) - 1 : 0;
+
+    QMap<QVector<int>, int> appendedCounts;
+    if(!countRange(_minedSize, fileSize, {}, appendedCounts, _appendedTransactionsCount)) {
+        return false;
+    }
+    _transactionsCount = _minedTransactionsCount + _appendedTransactionsCount;
+    int minCount = Apriori::minimumCount(minSupport, _transactionsCount);
+
+    for(auto it = _supports.cbegin(); it != _supports.cend(); it++) {
+        if(it.key().size() == 1 && !appendedCounts.contains(it.key())) {
+            appendedCounts[it.key()] = 0;
+        }
+    }
+    QVector<QVector<int>> candidates = appendedCounts.keys().toVector();
+
+    QMap<QVector<int>, Support> border;
+    while(!candidates.isEmpty()) {
+        QVector<QVector<int>> level;
+        QVector<QVector<int>> rescan;
+
+        auto classify = [&](const QVector<int> &itemset, const int count, const bool exact) {
+            if(count >= minCount) {
+                frequentItemsets[itemset] = count;
+                level.append(itemset);
+            } else {
+                border[itemset] = {count, exact};
+            }
+        };
+
+        for(const QVector<int> &candidate : candidates) {
+            int appendedCount = appendedCounts.value(candidate);
+            auto known = _supports.constFind(candidate);
+
+            if(known != _supports.cend() && known.value().exact) {
+                classify(candidate, known.value().count + appendedCount, true);
+                continue;
+            }
+
+            int upperBound = (known != _supports.cend() ? known.value().count : unknownBound) + appendedCount;
+            if(_minedTransactionsCount == 0) {
+                classify(candidate, appendedCount, true);
+            } else if(upperBound < minCount) {
+                border[candidate] = {upperBound, false};
+            } else {
+                rescan.append(candidate);
+            }
+        }
+
+        // Only itemsets that may newly cross the threshold touch the old data.
+        if(!rescan.isEmpty()) {
+            QMap<QVector<int>, int> minedCounts;
+            int minedTransactionsCount;
+            if(!countRange(0, _minedSize, rescan, minedCounts, minedTransactionsCount)) {
+                return false;
+            }
+
+            _rescannedCount += rescan.size();
+            for(const QVector<int> &candidate : rescan) {
+                classify(candidate, minedCounts.value(candidate) + appendedCounts.value(candidate), true);
+            }
+        }
+
+        candidates = Apriori::generateCandidates(level);
+        if(candidates.isEmpty()) {
+            break;
+        }
+
+        int appendedTransactionsCount;
+        if(!countRange(_minedSize, fileSize, candidates, appendedCounts, appendedTransactionsCount)) {
+            return false;
+        }
+    }
+
+    return saveState(minSupport, fileSize, frequentItemsets, border);
+}
+
+
+bool IncrementalMiner::loadState(const double minSupport, const qint64 fileSize)
+{
+    QFile file(_statePath);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream in(&file);
+    if(in.readLine() != "FUP 1") {
+        return false;
+    }
+
+    QMap<QString, QString> header;
+    for(int i = 0; i < 4; i++) {
+        QStringList parts = in.readLine().split(' ');
+        if(parts.size() != 2) {
+            return false;
+        }
+        header[parts[0]] = parts[1];
+    }
+
+    bool success;
+    _minedSize = header.value("source-size").toLongLong(&success);
+    if(!success || _minedSize <= 0 || _minedSize > fileSize) {
+        return false;
+    }
+    if(header.value("source-checksum") != sourceChecksum(_minedSize)) {
+        return false;
+    }
+    if(header.value("min-support").toDouble(&success) != minSupport || !success) {
+        return false;
+    }
+    _minedTransactionsCount = header.value("transactions").toInt(&success);
+    if(!success || _minedTransactionsCount <= 0) {
+        return false;
+    }
+
+    _supports.clear();
+    while(!in.atEnd()) {
+        QStringList parts = in.readLine().split(' ', Qt::SkipEmptyParts);
+        if(parts.size() < 3) {
+            return false;
+        }
+
+        Support support;
+        support.count = parts[1].toInt(&success);
+        support.exact = parts[0] != "U";
+        if(!success || (parts[0] != "F" && parts[0] != "B" && parts[0] != "U")) {
+            return false;
+        }
+
+        QVector<int> itemset;
+        for(int i = 2; i < parts.size(); i++) {
+            itemset.append(parts[i].toInt(&success));
+            if(!success) {
+                return false;
+            }
+        }
+
+        _supports[itemset] = support;
+    }
+
+    return true;
+}
+
+
+bool IncrementalMiner::saveState(
+    const double minSupport,
+    const qint64 fileSize,
+    const QMap<QVector<int>, int> &frequentItemsets,
+    const QMap<QVector<int>, Support> &border
+)
+{
+    QString checksum = sourceChecksum(fileSize);
+    if(checksum.isEmpty() || _transactionsCount == 0) {
+        // An input not ending in a newline could still grow its last line.
+        QFile::remove(_statePath);
+        return true;
+    }
+
+    QSaveFile file(_statePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        _errorString = "Unable to open the incremental state file";
+        return false;
+    }
+
+    auto itemsString = [](const QVector<int> &itemset) {
+        QString line;
+        for(int item : itemset) {
+            line += " " + QString::number(item);
+        }
+        return line;
+    };
+
+    QTextStream out(&file);
+    out << "FUP 1\n"
+        << "source-size " << fileSize << "\n"
+        << "source-checksum " << checksum << "\n"
+        << "min-support " << QString::number(minSupport, 'g', 17) << "\n"
+        << "transactions " << _transactionsCount << "\n";
+    for(auto it = frequentItemsets.cbegin(); it != frequentItemsets.cend(); it++) {
+        out << "F " << it.value() << itemsString(it.key()) << "\n";
+    }
+    for(auto it = border.cbegin(); it != border.cend(); it++) {
+        out << (it.value().exact ? "B " : "U ") << it.value().count << itemsString(it.key()) << "\n";
+    }
+    out.flush();
+
+    if(!file.commit()) {
+        _errorString = "Unable to write the incremental state file";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool IncrementalMiner::countRange(
+    const qint64 begin,
+    const qint64 end,
+    const QVector<QVector<int>> &candidates,
+    QMap<QVector<int>, int> &counts,
+    int &transactionsCount
+)
+{
+    TRACE_SCOPE("count range");
+
+    counts.clear();
+    transactionsCount = 0;
+
+    TransactionReader reader(_filePath);
+    reader.setRange(begin, end);
+    if(!reader.open()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    // Without candidates every single item is counted.
+    CandidateTrie trie;
+    for(const QVector<int> &candidate : candidates) {
+        trie.insert(candidate);
+    }
+
+    QVector<int> transaction;
+    while(reader.next(transaction)) {
+        QVector<int> items = Apriori::uniqueItems(transaction);
+        if(candidates.isEmpty()) {
+            for(int item : items) {
+                counts[QVector<int>{item}]++;
+            }
+        } else {
+            trie.count(items);
+        }
+        transactionsCount++;
+    }
+    if(reader.hasError()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    if(!candidates.isEmpty()) {
+        counts = trie.getCounts();
+    }
+
+    return true;
+}
+
+
+QString IncrementalMiner::sourceChecksum(const qint64 size)
+{
+    // The mined prefix must be unchanged and end on a line boundary for the
+    // appended tail to start with a new transaction.
+    QFile file(_filePath);
+    qint64 begin = std::max<qint64>(0, size - checksumWindow);
+    if(size <= 0 || !file.open(QIODevice::ReadOnly) || !file.seek(begin)) {
+        return QString();
+    }
+
+    QByteArray data = file.read(size - begin);
+    if(data.size() != size - begin || data.back() != '\n') {
+        return QString();
+    }
+
+    // FNV-1a
+    quint64 hash = 14695981039346656037ULL;
+    for(char byte : data) {
+        hash ^= static_cast<uchar>(byte);
+        hash *= 1099511628211ULL;
+    }
+
+    return QString::number(hash, 16);
+}
@@ -0,0 +1,90 @@
+#ifndef INCREMENTALMINER_H
+#define INCREMENTALMINER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include "apriori.h"
+#include "transactionreader.h"
+#include "profiler.h"
+
+
+// FUP-style incremental miner for files that only grow by appends. A state
+// file next to the output keeps the mined byte size, the frequent itemsets
+// and the negative border of the previous run:
+//
+//   FUP 1
+//   source-size <bytes>
+//   source-checksum <hash of the last bytes before source-size>
+//   min-support <s>
+//   transactions <n>
+//   F <count> <items>    frequent itemset, exact support
+//   B <count> <items>    negative border, exact support
+//   U <count> <items>    negative border, upper bound of the support
+//
+// A run scans only the appended tail, level by level. Candidates with a
+// known support are decided from it; the rest are bounded by the old
+// threshold and only those that may newly cross the threshold are counted
+// over the old data. A missing, stale or differently parameterised state
+// falls back to mining the whole file, which also writes a fresh state.
+class IncrementalMiner
+{
+public:
+    // Constructors
+    IncrementalMiner(const QString &filePath, const QString &statePath);
+
+    // Getters
+    int getTransactionsCount();
+    int getAppendedTransactionsCount();
+    int getRescannedCount();
+    bool isIncremental();
+    QString getErrorString();
+
+    // Functions
+    bool mine(const double minSupport, QMap<QVector<int>, int> &frequentItemsets);
+
+private:
+    struct Support
+    {
+        int count;
+        bool exact;
+    };
+
+    // Fields
+    QString _filePath;
+    QString _statePath;
+    qint64 _minedSize;
+    int _minedTransactionsCount;
+    QMap<QVector<int>, Support> _supports;
+    int _transactionsCount;
+    int _appendedTransactionsCount;
+    int _rescannedCount;
+    bool _incremental;
+    QString _errorString;
+
+    // Functions
+    bool loadState(const double minSupport, const qint64 fileSize);
+    bool saveState(
+        const double minSupport,
+        const qint64 fileSize,
+        const QMap<QVector<int>, int> &frequentItemsets,
+        const QMap<QVector<int>, Support> &border
+    );
+    bool countRange(
+        const qint64 begin,
+        const qint64 end,
+        const QVector<QVector<int>> &candidates,
+        QMap<QVector<int>, int> &counts,
+        int &transactionsCount
+    );
+    QString sourceChecksum(const qint64 size);
+};
+
+
+#endif // INCREMENTALMINER_H
@@ -0,0 +1,93 @@
+#include "itemconstraints.h"
+
+
+ItemConstraints::ItemConstraints()
+{
+}
+
+
+QSet<int> ItemConstraints::getRequiredItems()
+{
+    return _requiredItems;
+}
+
+
+QSet<int> ItemConstraints::getExcludedItems()
+{
+    return _excludedItems;
+}
+
+
+bool ItemConstraints::isEmpty()
+{
+    return _requiredItems.isEmpty() && _excludedItems.isEmpty();
+}
+
+
+bool ItemConstraints::isRequired(const int item)
+{
+    return _requiredItems.contains(item);
+}
+
+
+void ItemConstraints::setRequiredItems(const QSet<int> &requiredItems)
+{
+    _requiredItems = requiredItems;
+}
+
+
+void ItemConstraints::setExcludedItems(const QSet<int> &excludedItems)
+{
+    _excludedItems = excludedItems;
+}
+
+
+QVector<int> ItemConstraints::removeExcluded(const QVector<int> &transaction)
+{
+    if(_excludedItems.isEmpty()) {
+        return transaction;
+    }
+
+    QVector<int> items;
+    items.reserve(transaction.size());
+    for(int item : transaction) {
+        if(!_excludedItems.contains(item)) {
+            items.append(item);
+        }
+    }
+
+    return items;
+}
+
+
+bool ItemConstraints::isSatisfied(const QVector<int> &itemset)
+{
+    bool hasRequiredItem = _requiredItems.isEmpty();
+    for(int item : itemset) {
+        if(_excludedItems.contains(item)) {
+            return false;
+        }
+        hasRequiredItem = hasRequiredItem || _requiredItems.contains(item);
+    }
+
+    return hasRequiredItem;
+}
+
+
+bool ItemConstraints::parseItems(const QString &text, QSet<int> &items)
+{
+    items.clear();
+
+    QStringList parts = QString(text).replace(",", " ").split(" ", Qt::SkipEmptyParts);
+    for(const QString &part : parts) {
+        bool isNumber = false;
+        int item = part.toInt(&isNumber);
+        if(!isNumber) {
+            return false;
+        }
+
+        items.insert(item);
+    }
+
+    return true;
+}
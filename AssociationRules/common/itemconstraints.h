@@ -0,0 +1,42 @@
+#ifndef ITEMCONSTRAINTS_H
+#define ITEMCONSTRAINTS_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QSet>
+
+
+// Item constraints pushed into mining instead of filtering the output.
+// Excluded items (anti-monotone) are removed from the transactions at load
+// time. Required items (succinct) restrict the result to itemsets holding at
+// least one of them; miners only generate such itemsets.
+class ItemConstraints
+{
+public:
+    // Constructors
+    ItemConstraints();
+
+    // Getters
+    QSet<int> getRequiredItems();
+    QSet<int> getExcludedItems();
+    bool isEmpty();
+    bool isRequired(const int item);
+
+    // Setters
+    void setRequiredItems(const QSet<int> &requiredItems);
+    void setExcludedItems(const QSet<int> &excludedItems);
+
+    // Functions
+    QVector<int> removeExcluded(const QVector<int> &transaction);
+    bool isSatisfied(const QVector<int> &itemset);
+    static bool parseItems(const QString &text, QSet<int> &items);
+
+private:
+    // Fields
+    QSet<int> _requiredItems;
+    QSet<int> _excludedItems;
+};
+
+
+#endif // ITEMCONSTRAINTS_H
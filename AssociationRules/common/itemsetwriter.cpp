@@ -0,0 +1,142 @@
+#include "itemsetwriter.h"
+
+
+QString ItemsetWriter::formatItemset(
+    const QVector<int> &itemset,
+    const int support,
+    const qint64 transactionsCount,
+    const QString &category
+)
+{
+    const int itemsetWidth = 20;
+    const int supportWidth = 30;
+    const int categoryWidth = 20;
+
+    double supportPerc = static_cast<double>(support) / transactionsCount * 100;
+
+    QString itemsetString = "{";
+    for(int item : itemset) {
+        itemsetString += QString::number(item) + ", ";
+    }
+    itemsetString = itemsetString.removeLast().removeLast();
+    itemsetString += "}";
+
+    QString line = itemsetString.leftJustified(itemsetWidth)
+        + QString("#SUP: %1 (%2%)")
+            .arg(support)
+            .arg(supportPerc)
+            .leftJustified(supportWidth);
+
+    if(!category.isEmpty()) {
+        line += category.leftJustified(categoryWidth);
+    }
+
+    return line;
+}
+
+
+QVector<QPair<QVector<int>, int>> ItemsetWriter::sortBySetSize(const QMap<QVector<int>, int> &itemsets)
+{
+    QVector<QPair<QVector<int>, int>> itemList;
+
+    for(auto it = itemsets.cbegin(); it != itemsets.cend(); it++) {
+        itemList.append(qMakePair(it.key(), it.value()));
+    }
+
+    std::sort(itemList.begin(), itemList.end(),
+        [](const QPair<QVector<int>, int> &a, const QPair<QVector<int>, int> &b) {
+            if(a.first.size() == b.first.size()) {
+                return a.first < b.first;
+            }
+
+            return a.first.size() < b.first.size();
+        }
+    );
+
+    return itemList;
+}
+
+
+bool ItemsetWriter::write(
+    const QString &filePath,
+    const QMap<QVector<int>, int> &frequentItemsets,
+    const qint64 transactionsCount,
+    QString &errorString
+)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        errorString = "Unable to open the output file";
+        return false;
+    }
+
+    QTextStream out(&file);
+    bool success = write(out, frequentItemsets, transactionsCount);
+    file.close();
+
+    if(!success) {
+        errorString = "Unable to write the output file";
+    }
+
+    return success;
+}
+
+
+bool ItemsetWriter::write(
+    QTextStream &out,
+    const QMap<QVector<int>, int> &frequentItemsets,
+    const qint64 transactionsCount
+)
+{
+    // With downward closure it is enough to look at immediate supersets: an
+    // itemset is not maximal if one of them is frequent, and not closed if
+    // one of them has the same support.
+    QSet<QVector<int>> notClosed;
+    QSet<QVector<int>> notMaximal;
+    for(auto it = frequentItemsets.cbegin(); it != frequentItemsets.cend(); it++) {
+        const QVector<int> &superset = it.key();
+        if(superset.size() < 2) {
+            continue;
+        }
+
+        for(int removePos = 0; removePos < superset.size(); removePos++) {
+            QVector<int> subset = superset;
+            subset.removeAt(removePos);
+
+            auto found = frequentItemsets.find(subset);
+            if(found == frequentItemsets.end()) {
+                continue;
+            }
+
+            notMaximal.insert(subset);
+            if(found.value() == it.value()) {
+                notClosed.insert(subset);
+            }
+        }
+    }
+
+    for(const auto &pair : sortBySetSize(frequentItemsets)) {
+        const QVector<int> &itemset = pair.first;
+        if(itemset.size() == 0) {
+            continue;
+        }
+
+        bool closed = !notClosed.contains(itemset);
+        bool maximal = !notMaximal.contains(itemset);
+
+        QString category;
+        if(closed && maximal) {
+            category = "Closed and Maximal";
+        } else if(maximal) {
+            category = "Maximal";
+        } else if(closed) {
+            category = "Closed";
+        } else {
+            category = "Frequent";
+        }
+
+        out << formatItemset(itemset, pair.second, transactionsCount, category) << "\n";
+    }
+
+    return out.status() == QTextStream::Ok;
+}
@@ -0,0 +1,39 @@
+#ifndef ITEMSETWRITER_H
+#define ITEMSETWRITER_H
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QSet>
+#include <QFile>
+#include <QTextStream>
+
+
+// Writes frequent itemsets in the Grid tab's output format, classifying each
+// one as closed and/or maximal. Used by the command line and streaming modes,
+// which have no Grid instance to save through.
+class ItemsetWriter
+{
+public:
+    static QString formatItemset(
+        const QVector<int> &itemset,
+        const int support,
+        const qint64 transactionsCount,
+        const QString &category
+    );
+    static QVector<QPair<QVector<int>, int>> sortBySetSize(const QMap<QVector<int>, int> &itemsets);
+    static bool write(
+        const QString &filePath,
+        const QMap<QVector<int>, int> &frequentItemsets,
+        const qint64 transactionsCount,
+        QString &errorString
+    );
+    static bool write(
+        QTextStream &out,
+        const QMap<QVector<int>, int> &frequentItemsets,
+        const qint64 transactionsCount
+    );
+};
+
+
+#endif // ITEMSETWRITER_H
@@ -0,0 +1,134 @@
+#include "lossycounter.h"
+
+
+LossyCounter::LossyCounter(const double error, const int batchSize)
+{
+    _error = error;
+    _bucketWidth = std::max(1, static_cast<int>(std::ceil(1.0 / error)));
+    _batchSize = std::max(1, batchSize / _bucketWidth) * _bucketWidth;
+    _transactionsCount = 0;
+    _currentBucket = 0;
+}
+
+
+qint64 LossyCounter::getTransactionsCount()
+{
+    return _transactionsCount;
+}
+
+
+int LossyCounter::getEntriesCount()
+{
+    return _entries.size();
+}
+
+
+QMap<QVector<int>, int> LossyCounter::getFrequentItemsets(const double minSupport)
+{
+    // Only processed batches count; call flush() first to include the rest.
+    double minCount = (minSupport - _error) * _transactionsCount;
+
+    QMap<QVector<int>, int> frequentItemsets;
+    for(auto it = _entries.cbegin(); it != _entries.cend(); it++) {
+        if(it.value().count >= minCount) {
+            frequentItemsets[it.key()] = it.value().count;
+        }
+    }
+
+    return frequentItemsets;
+}
+
+
+bool LossyCounter::add(const QVector<int> &transaction)
+{
+    _batch.append(Apriori::uniqueItems(transaction));
+    if(_batch.size() < _batchSize) {
+        return false;
+    }
+
+    processBatch();
+
+    return true;
+}
+
+
+void LossyCounter::flush()
+{
+    processBatch();
+}
+
+
+void LossyCounter::processBatch()
+{
+    if(_batch.isEmpty()) {
+        return;
+    }
+
+    qint64 previousBucket = _currentBucket;
+    _transactionsCount += _batch.size();
+    _currentBucket = (_transactionsCount + _bucketWidth - 1) / _bucketWidth;
+
+    // Itemsets new to the table need one occurrence per bucket of the batch.
+    int insertCount = static_cast<int>(std::max<qint64>(1, _currentBucket - previousBucket));
+
+    QHash<int, int> itemCounts;
+    for(const QVector<int> &transaction : _batch) {
+        for(int item : transaction) {
+            itemCounts[item]++;
+        }
+    }
+
+    QMap<QVector<int>, int> counts;
+    for(auto it = itemCounts.cbegin(); it != itemCounts.cend(); it++) {
+        counts[QVector<int>{it.key()}] = it.value();
+    }
+
+    while(!counts.isEmpty()) {
+        QVector<QVector<int>> survivors;
+        for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+            if(it.value() == 0) {
+                continue;
+            }
+
+            auto entry = _entries.find(it.key());
+            if(entry != _entries.end()) {
+                entry.value().count += it.value();
+                survivors.append(it.key());
+            } else if(it.value() >= insertCount) {
+                _entries.insert(it.key(), {it.value(), _currentBucket - insertCount});
+                survivors.append(it.key());
+            }
+        }
+
+        QVector<QVector<int>> candidates = Apriori::generateCandidates(survivors);
+        if(candidates.isEmpty()) {
+            break;
+        }
+
+        CandidateTrie trie;
+        for(const QVector<int> &candidate : candidates) {
+            trie.insert(candidate);
+        }
+        for(const QVector<int> &transaction : _batch) {
+            if(transaction.size() >= candidates.first().size()) {
+                trie.count(transaction);
+            }
+        }
+        counts = trie.getCounts();
+    }
+
+    _batch.clear();
+    prune();
+}
+
+
+void LossyCounter::prune()
+{
+    for(auto it = _entries.begin(); it != _entries.end();) {
+        if(it.value().count + it.value().delta <= _currentBucket) {
+            it = _entries.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
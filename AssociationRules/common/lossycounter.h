@@ -0,0 +1,56 @@
+#ifndef LOSSYCOUNTER_H
+#define LOSSYCOUNTER_H
+
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+
+#include "apriori.h"
+
+
+// Approximate frequent itemsets over an unbounded stream with Lossy Counting
+// (Manku, Motwani). The stream is cut into buckets of ceil(1 / error)
+// transactions and processed in batches of whole buckets; an itemset enters
+// the table once it occurs in a batch at least once per bucket of the batch,
+// and entries whose count plus maximal missed count fall to the current
+// bucket number are dropped. Reported supports undercount by at most
+// error * transactions and no itemset with support >= minSupport is missed.
+class LossyCounter
+{
+public:
+    // Constructors
+    LossyCounter(const double error, const int batchSize);
+
+    // Getters
+    qint64 getTransactionsCount();
+    int getEntriesCount();
+    QMap<QVector<int>, int> getFrequentItemsets(const double minSupport);
+
+    // Functions
+    bool add(const QVector<int> &transaction);
+    void flush();
+
+private:
+    struct Entry
+    {
+        int count;
+        qint64 delta;
+    };
+
+    // Fields
+    double _error;
+    int _bucketWidth;
+    int _batchSize;
+    qint64 _transactionsCount;
+    qint64 _currentBucket;
+    QHash<QVector<int>, Entry> _entries;
+    QVector<QVector<int>> _batch;
+
+    // Functions
+    void processBatch();
+    void prune();
+};
+
+
+#endif // LOSSYCOUNTER_H
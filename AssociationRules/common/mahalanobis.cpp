@@ -0,0 +1,221 @@
+#include "mahalanobis.h"
+
+
+// Columns per block of the Cholesky decomposition.
+static const int blockSize = 64;
+// Attempts at growing the diagonal before giving up on a reference set.
+static const int regularizationAttempts = 12;
+
+
+static double dot(const double *a, const double *b, const int length)
+{
+    double sum = 0;
+    for(int i = 0; i < length; i++) {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+
+Mahalanobis::Mahalanobis()
+{
+    _dimension = 0;
+    _samplesCount = 0;
+    _regularization = 0;
+}
+
+
+int Mahalanobis::getDimension() const
+{
+    return _dimension;
+}
+
+
+int Mahalanobis::getSamplesCount() const
+{
+    return _samplesCount;
+}
+
+
+double Mahalanobis::getRegularization() const
+{
+    return _regularization;
+}
+
+
+QString Mahalanobis::getErrorString() const
+{
+    return _errorString;
+}
+
+
+bool Mahalanobis::fit(const VectorSet &reference)
+{
+    _dimension = 0;
+    _samplesCount = 0;
+    _regularization = 0;
+    _factor.clear();
+    _errorString.clear();
+
+    int n = reference.getDimension();
+    int samplesCount = reference.getRowsCount();
+    if(samplesCount < 2) {
+        _errorString = "The reference dataset needs at least two vectors";
+        return false;
+    }
+
+    std::vector<double> mean(n, 0.0);
+    for(int row = 0; row < samplesCount; row++) {
+        const double *values = reference.getRow(row);
+        for(int i = 0; i < n; i++) {
+            mean[i] += values[i];
+        }
+    }
+    for(int i = 0; i < n; i++) {
+        mean[i] /= samplesCount;
+    }
+
+    // Lower triangle of the sample covariance, row-major.
+    std::vector<double> covariance(static_cast<size_t>(n) * n, 0.0);
+    std::vector<double> centered(n);
+    for(int row = 0; row < samplesCount; row++) {
+        const double *values = reference.getRow(row);
+        for(int i = 0; i < n; i++) {
+            centered[i] = values[i] - mean[i];
+        }
+        for(int i = 0; i < n; i++) {
+            double *covarianceRow = covariance.data() + static_cast<size_t>(i) * n;
+            for(int j = 0; j <= i; j++) {
+                covarianceRow[j] += centered[i] * centered[j];
+            }
+        }
+    }
+
+    double trace = 0;
+    for(int i = 0; i < n; i++) {
+        for(int j = 0; j <= i; j++) {
+            covariance[static_cast<size_t>(i) * n + j] /= samplesCount - 1;
+        }
+        trace += covariance[static_cast<size_t>(i) * n + i];
+    }
+
+    // A singular covariance gets a ridge, starting tiny relative to the data.
+    double ridge = 1e-10 * (trace > 0 ? trace / n : 1.0);
+    _factor = covariance;
+    for(int attempt = 0; !factor(_factor, n); attempt++) {
+        if(attempt == regularizationAttempts) {
+            _factor.clear();
+            _errorString = "The covariance of the reference dataset could not be factored";
+            return false;
+        }
+
+        _factor = covariance;
+        for(int i = 0; i < n; i++) {
+            _factor[static_cast<size_t>(i) * n + i] += ridge;
+        }
+        _regularization = ridge;
+        ridge *= 10;
+    }
+
+    _dimension = n;
+    _samplesCount = samplesCount;
+    _workspace.assign(n, 0.0);
+
+    return true;
+}
+
+
+double Mahalanobis::distance(const double *a, const double *b)
+{
+    return distance(a, b, _workspace.data());
+}
+
+
+double Mahalanobis::distance(const double *a, const double *b, double *workspace) const
+{
+    for(int i = 0; i < _dimension; i++) {
+        workspace[i] = a[i] - b[i];
+    }
+    solve(workspace);
+
+    return std::sqrt(dot(workspace, workspace, _dimension));
+}
+
+
+void Mahalanobis::whiten(const VectorSet &vectors, VectorSet &whitened) const
+{
+    whitened = VectorSet();
+
+    QVector<double> vector(_dimension);
+    for(int row = 0; row < vectors.getRowsCount(); row++) {
+        std::copy(vectors.getRow(row), vectors.getRow(row) + _dimension, vector.begin());
+        solve(vector.data());
+        whitened.append(vector);
+    }
+}
+
+
+bool Mahalanobis::factor(std::vector<double> &matrix, const int dimension)
+{
+    // Right-looking blocked Cholesky on the lower triangle: factor a diagonal
+    // block, solve the panel below it, then update the trailing submatrix.
+    // Rows are contiguous, so every inner product runs over two row slices.
+    int n = dimension;
+    double *a = matrix.data();
+    auto at = [a, n](const int i, const int j) -> double & {
+        return a[static_cast<size_t>(i) * n + j];
+    };
+
+    double largestDiagonal = 0;
+    for(int i = 0; i < n; i++) {
+        largestDiagonal = std::max(largestDiagonal, at(i, i));
+    }
+    double tolerance = 1e-12 * largestDiagonal;
+
+    for(int blockBegin = 0; blockBegin < n; blockBegin += blockSize) {
+        int blockEnd = std::min(blockBegin + blockSize, n);
+
+        for(int i = blockBegin; i < blockEnd; i++) {
+            for(int j = blockBegin; j <= i; j++) {
+                double sum = at(i, j) - dot(&at(i, blockBegin), &at(j, blockBegin), j - blockBegin);
+                if(i == j) {
+                    if(!(sum > tolerance)) {
+                        return false;
+                    }
+                    at(i, i) = std::sqrt(sum);
+                } else {
+                    at(i, j) = sum / at(j, j);
+                }
+            }
+        }
+
+        for(int i = blockEnd; i < n; i++) {
+            for(int j = blockBegin; j < blockEnd; j++) {
+                at(i, j) = (at(i, j) - dot(&at(i, blockBegin), &at(j, blockBegin), j - blockBegin)) / at(j, j);
+            }
+        }
+
+        for(int i = blockEnd; i < n; i++) {
+            for(int j = blockEnd; j <= i; j++) {
+                at(i, j) -= dot(&at(i, blockBegin), &at(j, blockBegin), blockEnd - blockBegin);
+            }
+        }
+    }
+
+    for(int i = 0; i < n; i++) {
+        std::fill(&at(i, 0) + i + 1, &at(i, 0) + n, 0.0);
+    }
+
+    return true;
+}
+
+
+void Mahalanobis::solve(double *vector) const
+{
+    // Forward substitution L * y = vector, in place.
+    for(int i = 0; i < _dimension; i++) {
+        const double *factorRow = _factor.data() + static_cast<size_t>(i) * _dimension;
+        vector[i] = (vector[i] - dot(factorRow, vector, i)) / factorRow[i];
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef MAHALANOBIS_H
+#define MAHALANOBIS_H
+
+#include <QString>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "vectorset.h"
+
+
+// Mahalanobis distance against the covariance of a reference dataset. fit()
+// estimates the sample covariance once and factors it as L * L^T with a
+// blocked Cholesky decomposition; if the covariance is singular or nearly
+// so, a growing multiple of its mean variance is added to the diagonal until
+// the factorisation succeeds (see getRegularization()).
+//
+// With the factor cached, the distance of two vectors is the length of
+// L^-1 (a - b): one forward substitution over the row-major factor, O(n^2)
+// per query and no allocation. whiten() maps whole sets through L^-1 once,
+// after which Mahalanobis distances are plain Euclidean distances, which is
+// how the Distance tab's batch mode uses it.
+class Mahalanobis
+{
+public:
+    // Constructors
+    Mahalanobis();
+
+    // Getters
+    int getDimension() const;
+    int getSamplesCount() const;
+    double getRegularization() const;
+    QString getErrorString() const;
+
+    // Functions
+    bool fit(const VectorSet &reference);
+    double distance(const double *a, const double *b);
+    double distance(const double *a, const double *b, double *workspace) const;
+    void whiten(const VectorSet &vectors, VectorSet &whitened) const;
+
+private:
+    // Fields
+    int _dimension;
+    int _samplesCount;
+    double _regularization;
+    std::vector<double> _factor;
+    std::vector<double> _workspace;
+    QString _errorString;
+
+    // Functions
+    static bool factor(std::vector<double> &matrix, const int dimension);
+    void solve(double *vector) const;
+};
+
+
+#endif // MAHALANOBIS_H
@@ -0,0 +1,345 @@
+#include "minhashindex.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MINHASH_INDEX_X86
+#include <immintrin.h>
+#endif
+
+
+// MurmurHash3 finalizer: a bijection on 32-bit values.
+static inline quint32 mix(quint32 value)
+{
+    value ^= value >> 16;
+    value *= 0x85ebca6bU;
+    value ^= value >> 13;
+    value *= 0xc2b2ae35U;
+    value ^= value >> 16;
+
+    return value;
+}
+
+
+static void portableSignature(const int *items, const int itemsCount, const quint32 *seeds, const int length, quint32 *signature)
+{
+    std::fill(signature, signature + length, 0xffffffffU);
+    for(int i = 0; i < itemsCount; i++) {
+        quint32 item = static_cast<quint32>(items[i]);
+        for(int j = 0; j < length; j++) {
+            signature[j] = std::min(signature[j], mix(item ^ seeds[j]));
+        }
+    }
+}
+
+
+#ifdef MINHASH_INDEX_X86
+__attribute__((target("avx2")))
+static void avx2Signature(const int *items, const int itemsCount, const quint32 *seeds, const int length, quint32 *signature)
+{
+    const __m256i multiplier1 = _mm256_set1_epi32(static_cast<int>(0x85ebca6bU));
+    const __m256i multiplier2 = _mm256_set1_epi32(static_cast<int>(0xc2b2ae35U));
+
+    for(int j = 0; j < length; j += 8) {
+        __m256i seed = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(seeds + j));
+        __m256i minimum = _mm256_set1_epi32(-1);
+        for(int i = 0; i < itemsCount; i++) {
+            __m256i value = _mm256_xor_si256(_mm256_set1_epi32(items[i]), seed);
+            value = _mm256_xor_si256(value, _mm256_srli_epi32(value, 16));
+            value = _mm256_mullo_epi32(value, multiplier1);
+            value = _mm256_xor_si256(value, _mm256_srli_epi32(value, 13));
+            value = _mm256_mullo_epi32(value, multiplier2);
+            value = _mm256_xor_si256(value, _mm256_srli_epi32(value, 16));
+            minimum = _mm256_min_epu32(minimum, value);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(signature + j), minimum);
+    }
+}
+#endif
+
+
+MinHashIndex::MinHashIndex(const int bandsCount, const int rowsPerBand, const int threadsCount, const quint32 seed)
+{
+    _bandsCount = std::max(1, bandsCount);
+    _rowsPerBand = std::max(1, rowsPerBand);
+    // Padded to whole AVX2 registers; the padding values are never banded.
+    _signatureLength = (_bandsCount * _rowsPerBand + 7) / 8 * 8;
+    _threadsCount = threadsCount > 0 ? threadsCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    _candidatesCount = 0;
+
+    quint32 state = seed;
+    for(int j = 0; j < _signatureLength; j++) {
+        state = mix(state + 0x9e3779b9U);
+        _seeds.push_back(state);
+    }
+
+    _signatureKernel = portableSignature;
+    _instructionSet = "portable";
+#ifdef MINHASH_INDEX_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        _signatureKernel = avx2Signature;
+        _instructionSet = "AVX2";
+    }
+#endif
+}
+
+
+int MinHashIndex::getTransactionsCount()
+{
+    return _transactions.size();
+}
+
+
+qint64 MinHashIndex::getCandidatesCount()
+{
+    return _candidatesCount;
+}
+
+
+QString MinHashIndex::getInstructionSet()
+{
+    return _instructionSet;
+}
+
+
+void MinHashIndex::build(const QVector<QVector<int>> &transactions)
+{
+    _transactions = transactions;
+    int transactionsCount = _transactions.size();
+
+    // The copy shares its rows with the caller's vector, so rows are detached
+    // and normalised here, before the threads only read them.
+    for(int tid = 0; tid < transactionsCount; tid++) {
+        QVector<int> &items = _transactions[tid];
+        std::sort(items.begin(), items.end());
+        items.erase(std::unique(items.begin(), items.end()), items.end());
+    }
+
+    // Identical transactions point to the first of them.
+    std::vector<int> order(transactionsCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](const int a, const int b) {
+        return std::lexicographical_compare(_transactions[a].begin(), _transactions[a].end(), _transactions[b].begin(), _transactions[b].end());
+    });
+    _representatives.assign(transactionsCount, 0);
+    for(int i = 0; i < transactionsCount; i++) {
+        bool same = i > 0 && _transactions[order[i]] == _transactions[order[i - 1]];
+        _representatives[order[i]] = same ? _representatives[order[i - 1]] : order[i];
+    }
+
+    _signatures.assign(static_cast<size_t>(transactionsCount) * _signatureLength, 0);
+    parallelFor(transactionsCount, [this](const int begin, const int end) {
+        for(int tid = begin; tid < end; tid++) {
+            const QVector<int> &items = _transactions.at(tid);
+            _signatureKernel(items.constData(), items.size(), _seeds.data(), _signatureLength,
+                _signatures.data() + static_cast<size_t>(tid) * _signatureLength);
+        }
+    });
+
+    // Empty transactions are similar to nothing and stay out of the tables.
+    _bands.assign(_bandsCount, {});
+    parallelFor(_bandsCount, [this, transactionsCount](const int begin, const int end) {
+        for(int band = begin; band < end; band++) {
+            std::vector<BandEntry> &entries = _bands[band];
+            for(int tid = 0; tid < transactionsCount; tid++) {
+                if(!_transactions.at(tid).isEmpty()) {
+                    entries.push_back({bandHash(_signatures.data() + static_cast<size_t>(tid) * _signatureLength, band), tid});
+                }
+            }
+            std::sort(entries.begin(), entries.end());
+        }
+    });
+}
+
+
+QVector<MinHashIndex::SimilarPair> MinHashIndex::topK(const int transaction, const int k)
+{
+    _candidatesCount = 0;
+    if(transaction < 0 || transaction >= _transactions.size()) {
+        return {};
+    }
+
+    return query(transaction, k);
+}
+
+
+QVector<MinHashIndex::SimilarPair> MinHashIndex::topKForAll(const int k)
+{
+    _candidatesCount = 0;
+
+    int transactionsCount = _transactions.size();
+    std::vector<QVector<SimilarPair>> results(transactionsCount);
+    parallelFor(transactionsCount, [this, k, &results](const int begin, const int end) {
+        for(int tid = begin; tid < end; tid++) {
+            results[tid] = query(tid, k);
+        }
+    });
+
+    QVector<SimilarPair> pairs;
+    for(const QVector<SimilarPair> &result : results) {
+        pairs += result;
+    }
+
+    return pairs;
+}
+
+
+QVector<MinHashIndex::SimilarPair> MinHashIndex::pairsAbove(const double threshold)
+{
+    // Every pair of distinct transactions within one bucket of one band is a
+    // candidate. Identical transactions share all their buckets, so a bucket
+    // lists each of them once, through the first of them; otherwise a few
+    // thousand copies of one basket would give millions of pairs per band.
+    std::vector<std::vector<quint64>> bandCandidates(_bandsCount);
+    parallelFor(_bandsCount, [this, &bandCandidates](const int begin, const int end) {
+        std::vector<int> members;
+        for(int band = begin; band < end; band++) {
+            const std::vector<BandEntry> &entries = _bands[band];
+            for(size_t first = 0; first < entries.size();) {
+                members.clear();
+                size_t last = first;
+                while(last < entries.size() && entries[last].hash == entries[first].hash) {
+                    members.push_back(_representatives[entries[last].transaction]);
+                    last++;
+                }
+                std::sort(members.begin(), members.end());
+                members.erase(std::unique(members.begin(), members.end()), members.end());
+                for(size_t a = 0; a < members.size(); a++) {
+                    for(size_t b = a + 1; b < members.size(); b++) {
+                        bandCandidates[band].push_back(static_cast<quint64>(members[a]) << 32 | static_cast<quint32>(members[b]));
+                    }
+                }
+                first = last;
+            }
+        }
+    });
+
+    // Each copy of a transaction is paired once, with the first of them.
+    std::vector<quint64> candidates;
+    for(int tid = 0; tid < _transactions.size(); tid++) {
+        if(_representatives[tid] != tid && !_transactions[tid].isEmpty()) {
+            candidates.push_back(static_cast<quint64>(_representatives[tid]) << 32 | static_cast<quint32>(tid));
+        }
+    }
+    for(std::vector<quint64> &band : bandCandidates) {
+        candidates.insert(candidates.end(), band.begin(), band.end());
+        std::vector<quint64>().swap(band);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    _candidatesCount = static_cast<qint64>(candidates.size());
+
+    std::vector<double> similarities(candidates.size());
+    parallelFor(static_cast<int>(candidates.size()), [this, &candidates, &similarities](const int begin, const int end) {
+        for(int i = begin; i < end; i++) {
+            similarities[i] = jaccard(_transactions.at(static_cast<int>(candidates[i] >> 32)), _transactions.at(static_cast<int>(candidates[i] & 0xffffffffU)));
+        }
+    });
+
+    QVector<SimilarPair> pairs;
+    for(size_t i = 0; i < candidates.size(); i++) {
+        if(similarities[i] >= threshold) {
+            pairs.append({static_cast<int>(candidates[i] >> 32), static_cast<int>(candidates[i] & 0xffffffffU), similarities[i]});
+        }
+    }
+
+    return pairs;
+}
+
+
+double MinHashIndex::jaccard(const QVector<int> &a, const QVector<int> &b)
+{
+    int intersection = 0;
+    int i = 0;
+    int j = 0;
+    while(i < a.size() && j < b.size()) {
+        if(a[i] == b[j]) {
+            intersection++;
+            i++;
+            j++;
+        } else if(a[i] < b[j]) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+
+    int unionCount = a.size() + b.size() - intersection;
+
+    return unionCount == 0 ? 0.0 : static_cast<double>(intersection) / unionCount;
+}
+
+
+quint64 MinHashIndex::bandHash(const quint32 *signature, const int band)
+{
+    // FNV-1a over the band's values.
+    quint64 hash = 14695981039346656037ULL;
+    for(int row = band * _rowsPerBand; row < (band + 1) * _rowsPerBand; row++) {
+        hash ^= signature[row];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
+QVector<MinHashIndex::SimilarPair> MinHashIndex::query(const int transaction, const int k)
+{
+    if(_transactions.at(transaction).isEmpty() || k <= 0) {
+        return {};
+    }
+
+    const quint32 *signature = _signatures.data() + static_cast<size_t>(transaction) * _signatureLength;
+    std::vector<int> candidates;
+    for(int band = 0; band < _bandsCount; band++) {
+        BandEntry key = {bandHash(signature, band), 0};
+        const std::vector<BandEntry> &entries = _bands[band];
+        for(auto it = std::lower_bound(entries.begin(), entries.end(), key); it != entries.end() && it->hash == key.hash; it++) {
+            if(it->transaction != transaction) {
+                candidates.push_back(it->transaction);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    _candidatesCount += static_cast<qint64>(candidates.size());
+
+    QVector<SimilarPair> pairs;
+    for(int candidate : candidates) {
+        pairs.append({transaction, candidate, jaccard(_transactions.at(transaction), _transactions.at(candidate))});
+    }
+
+    auto moreSimilar = [](const SimilarPair &a, const SimilarPair &b) {
+        if(a.similarity == b.similarity) {
+            return a.second < b.second;
+        }
+
+        return a.similarity > b.similarity;
+    };
+    int kept = std::min(k, static_cast<int>(pairs.size()));
+    std::partial_sort(pairs.begin(), pairs.begin() + kept, pairs.end(), moreSimilar);
+    pairs.resize(kept);
+
+    return pairs;
+}
+
+
+void MinHashIndex::parallelFor(const int count, const std::function<void(const int begin, const int end)> &function)
+{
+    // Small chunks from a shared counter keep threads busy on uneven work.
+    int chunk = std::max(1, std::min(1024, count / (_threadsCount * 8)));
+    std::atomic<int> next(0);
+    auto work = [&]() {
+        for(int begin = next.fetch_add(chunk); begin < count; begin = next.fetch_add(chunk)) {
+            function(begin, std::min(begin + chunk, count));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(int thread = 1; thread < std::min(_threadsCount, (count + chunk - 1) / chunk); thread++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for(std::thread &thread : threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef MINHASHINDEX_H
+#define MINHASHINDEX_H
+
+#include <QString>
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+
+// Approximate Jaccard similarity search over transactions. Every transaction
+// gets a MinHash signature of bandsCount * rowsPerBand values; each value is
+// the minimum of a seeded 32-bit bijective hash over the transaction's items,
+// so two transactions agree on it with probability equal to their Jaccard
+// similarity. Signatures are cut into bands and each band is hashed into a
+// table sorted by band hash (LSH banding): transactions sharing any band
+// become candidates, which happens with probability 1 - (1 - s^r)^b for
+// similarity s. Candidates are verified with the exact Jaccard similarity, so
+// results have no false positives; pairs that share no band are missed.
+// pairsAbove reports a group of identical transactions once: every copy is
+// paired with the first transaction of the group, which alone stands for the
+// group in the pairs with other transactions.
+//
+// Signatures are computed eight hash functions at a time with AVX2 when the
+// CPU has it. Signatures, band tables, candidate verification and the all-
+// transactions top-k queries are spread over threads.
+class MinHashIndex
+{
+public:
+    struct SimilarPair
+    {
+        int first;
+        int second;
+        double similarity;
+    };
+
+    // Constructors
+    MinHashIndex(const int bandsCount, const int rowsPerBand, const int threadsCount = 0, const quint32 seed = 0);
+
+    // Getters
+    int getTransactionsCount();
+    qint64 getCandidatesCount();
+    QString getInstructionSet();
+
+    // Functions
+    void build(const QVector<QVector<int>> &transactions);
+    QVector<SimilarPair> topK(const int transaction, const int k);
+    QVector<SimilarPair> topKForAll(const int k);
+    QVector<SimilarPair> pairsAbove(const double threshold);
+    static double jaccard(const QVector<int> &a, const QVector<int> &b);
+
+private:
+    typedef void (*SignatureKernel)(const int *items, const int itemsCount, const quint32 *seeds, const int length, quint32 *signature);
+
+    struct BandEntry
+    {
+        quint64 hash;
+        int transaction;
+
+        bool operator<(const BandEntry &other) const
+        {
+            return hash < other.hash || (hash == other.hash && transaction < other.transaction);
+        }
+    };
+
+    // Fields
+    int _bandsCount;
+    int _rowsPerBand;
+    int _signatureLength;
+    int _threadsCount;
+    std::vector<quint32> _seeds;
+    std::vector<quint32> _signatures;
+    std::vector<std::vector<BandEntry>> _bands;
+    std::vector<int> _representatives;
+    QVector<QVector<int>> _transactions;
+    std::atomic<qint64> _candidatesCount;
+    SignatureKernel _signatureKernel;
+    QString _instructionSet;
+
+    // Functions
+    quint64 bandHash(const quint32 *signature, const int band);
+    QVector<SimilarPair> query(const int transaction, const int k);
+    void parallelFor(const int count, const std::function<void(const int begin, const int end)> &function);
+};
+
+
+#endif // MINHASHINDEX_H
@@ -0,0 +1,69 @@
+#include "mrgexp.h"
+
+
+MRGExp::MRGExp()
+{
+    _frequentGeneratorsCount = 0;
+}
+
+
+int MRGExp::getFrequentGeneratorsCount()
+{
+    return _frequentGeneratorsCount;
+}
+
+
+QMap<QVector<int>, int> MRGExp::mine(const QVector<QVector<int>> &transactions, const int minCount)
+{
+    QMap<QVector<int>, int> minimalRare;
+    _frequentGeneratorsCount = 0;
+
+    QHash<int, int> itemsCounts;
+    for(const QVector<int> &transaction : transactions) {
+        for(int item : Apriori::uniqueItems(transaction)) {
+            itemsCounts[item]++;
+        }
+    }
+
+    // An item in every transaction has the support of the empty set, so it is
+    // frequent but not a generator.
+    QHash<QVector<int>, int> generators;
+    for(auto it = itemsCounts.cbegin(); it != itemsCounts.cend(); it++) {
+        if(it.value() < minCount) {
+            minimalRare[QVector<int>{it.key()}] = it.value();
+        } else if(it.value() < transactions.size()) {
+            generators[QVector<int>{it.key()}] = it.value();
+        }
+    }
+
+    while(!generators.isEmpty()) {
+        _frequentGeneratorsCount += generators.size();
+
+        // Candidates whose subsets are all frequent generators.
+        QVector<QVector<int>> candidates = Apriori::generateCandidates(generators.keys().toVector());
+        QMap<QVector<int>, int> counts = Apriori::countSupports(transactions, candidates);
+
+        QHash<QVector<int>, int> nextGenerators;
+        for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+            if(it.value() < minCount) {
+                minimalRare[it.key()] = it.value();
+                continue;
+            }
+
+            bool generator = true;
+            for(int removePos = 0; removePos < it.key().size() && generator; removePos++) {
+                QVector<int> subset = it.key();
+                subset.removeAt(removePos);
+                generator = it.value() < generators.value(subset);
+            }
+
+            if(generator) {
+                nextGenerators[it.key()] = it.value();
+            }
+        }
+
+        generators = std::move(nextGenerators);
+    }
+
+    return minimalRare;
+}
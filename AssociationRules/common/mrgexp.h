@@ -0,0 +1,36 @@
+#ifndef MRGEXP_H
+#define MRGEXP_H
+
+#include <QVector>
+#include <QMap>
+#include <QHash>
+
+#include "apriori.h"
+
+
+// MRG-Exp: minimal rare itemsets as minimal rare generators. Every minimal
+// rare itemset is a generator whose proper subsets are all frequent
+// generators, so the level-wise search only keeps frequent generators, i.e.
+// frequent itemsets with a support below that of each of their subsets.
+// Non-generators are dropped as soon as they are counted, together with all
+// their supersets, and every rare candidate is already minimal. Only the
+// generators and the border are ever stored.
+class MRGExp
+{
+public:
+    // Constructors
+    MRGExp();
+
+    // Getters
+    int getFrequentGeneratorsCount();
+
+    // Functions
+    QMap<QVector<int>, int> mine(const QVector<QVector<int>> &transactions, const int minCount);
+
+private:
+    // Fields
+    int _frequentGeneratorsCount;
+};
+
+
+#endif // MRGEXP_H
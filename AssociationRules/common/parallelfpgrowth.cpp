@@ -0,0 +1,279 @@
+#include "parallelfpgrowth.h"
+
+
+// Conditional trees with at least this many nodes become tasks of their own.
+static const size_t splitThreshold = 2048;
+
+
+ParallelFPGrowth::ParallelFPGrowth(const QVector<int> &itemsOrder, const int threadsCount)
+{
+    _itemsOrder = itemsOrder;
+    _threadsCount = std::max(1, threadsCount);
+    _minCount = 1;
+    _pendingTasks = 0;
+    _tasksCount = 0;
+    _stolenCount = 0;
+}
+
+
+int ParallelFPGrowth::getTasksCount()
+{
+    return _tasksCount;
+}
+
+
+int ParallelFPGrowth::getStolenCount()
+{
+    return _stolenCount;
+}
+
+
+QMap<QVector<int>, int> ParallelFPGrowth::mine(
+    const QVector<QVector<int>> &orderedTransactions,
+    const int minCount,
+    const QVector<int> &suffixItems
+)
+{
+    _minCount = std::max(1, minCount);
+    _tasksCount = 0;
+    _stolenCount = 0;
+
+    QHash<int, int> ranks;
+    for(int rank = 0; rank < _itemsOrder.size(); rank++) {
+        ranks.insert(_itemsOrder[rank], rank);
+    }
+
+    std::shared_ptr<Tree> tree = std::make_shared<Tree>();
+    initTree(*tree, _itemsOrder.size());
+    std::vector<int> path;
+    for(const QVector<int> &transaction : orderedTransactions) {
+        path.clear();
+        for(int item : transaction) {
+            int rank = ranks.value(item, -1);
+            if(rank >= 0) {
+                path.push_back(rank);
+            }
+        }
+        insertPath(*tree, path, 1);
+    }
+    _tree = tree;
+
+    for(int i = 0; i < _threadsCount; i++) {
+        _workers.push_back(new Worker());
+    }
+
+    int next = 0;
+    for(int item : suffixItems) {
+        int rank = ranks.value(item, -1);
+        if(rank < 0 || _tree->rankSupports[rank] < _minCount) {
+            continue;
+        }
+
+        Task task;
+        task.tree = _tree;
+        task.rank = rank;
+        pushTask(next, std::move(task));
+        next = (next + 1) % _threadsCount;
+    }
+
+    std::vector<std::thread> threads;
+    for(int i = 1; i < _threadsCount; i++) {
+        threads.emplace_back(&ParallelFPGrowth::work, this, i);
+    }
+    work(0);
+    for(std::thread &thread : threads) {
+        thread.join();
+    }
+
+    QMap<QVector<int>, int> frequentItemsets;
+    for(Worker *worker : _workers) {
+        for(const auto &result : worker->results) {
+            QVector<int> itemset;
+            for(int rank : result.first) {
+                itemset.append(_itemsOrder[rank]);
+            }
+            std::sort(itemset.begin(), itemset.end());
+            frequentItemsets.insert(itemset, result.second);
+        }
+        delete worker;
+    }
+    _workers.clear();
+    _tree.reset();
+
+    return frequentItemsets;
+}
+
+
+void ParallelFPGrowth::initTree(Tree &tree, const int ranksCount)
+{
+    tree.ranks.assign(1, -1);
+    tree.parents.assign(1, -1);
+    tree.counts.assign(1, 0);
+    tree.firstChildren.assign(1, -1);
+    tree.nextSiblings.assign(1, -1);
+    tree.nextNodes.assign(1, -1);
+    tree.rankHeads.assign(ranksCount, -1);
+    tree.rankSupports.assign(ranksCount, 0);
+}
+
+
+void ParallelFPGrowth::insertPath(Tree &tree, const std::vector<int> &path, const int count)
+{
+    int node = 0;
+    for(int rank : path) {
+        int child = tree.firstChildren[node];
+        while(child >= 0 && tree.ranks[child] != rank) {
+            child = tree.nextSiblings[child];
+        }
+
+        if(child < 0) {
+            child = tree.ranks.size();
+            tree.ranks.push_back(rank);
+            tree.parents.push_back(node);
+            tree.counts.push_back(0);
+            tree.firstChildren.push_back(-1);
+            tree.nextSiblings.push_back(tree.firstChildren[node]);
+            tree.nextNodes.push_back(tree.rankHeads[rank]);
+            tree.firstChildren[node] = child;
+            tree.rankHeads[rank] = child;
+        }
+
+        node = child;
+        tree.counts[node] += count;
+        tree.rankSupports[rank] += count;
+    }
+}
+
+
+void ParallelFPGrowth::work(const int workerIndex)
+{
+    TRACE_SCOPE_VALUE("worker", "index", workerIndex);
+
+    Task task;
+    while(true) {
+        if(popTask(workerIndex, task) || stealTask(workerIndex, task)) {
+            if(task.rank >= 0) {
+                mineRank(workerIndex, *task.tree, task.rank, task.suffix);
+            } else {
+                mineTree(workerIndex, task.tree, task.suffix);
+            }
+            task.tree.reset();
+            _pendingTasks--;
+            continue;
+        }
+
+        if(_pendingTasks == 0) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+}
+
+
+bool ParallelFPGrowth::popTask(const int workerIndex, Task &task)
+{
+    Worker *worker = _workers[workerIndex];
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    if(worker->tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(worker->tasks.back());
+    worker->tasks.pop_back();
+
+    return true;
+}
+
+
+bool ParallelFPGrowth::stealTask(const int workerIndex, Task &task)
+{
+    for(int offset = 1; offset < _threadsCount; offset++) {
+        Worker *victim = _workers[(workerIndex + offset) % _threadsCount];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if(victim->tasks.empty()) {
+            continue;
+        }
+
+        task = std::move(victim->tasks.front());
+        victim->tasks.pop_front();
+        _stolenCount++;
+
+        return true;
+    }
+
+    return false;
+}
+
+
+void ParallelFPGrowth::pushTask(const int workerIndex, Task &&task)
+{
+    _pendingTasks++;
+    _tasksCount++;
+
+    Worker *worker = _workers[workerIndex];
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->tasks.push_back(std::move(task));
+}
+
+
+void ParallelFPGrowth::mineRank(const int workerIndex, const Tree &tree, const int rank, const std::vector<int> &suffix)
+{
+    TRACE_SCOPE_VALUE("mine item", "rank", rank);
+
+    std::vector<int> itemset;
+    itemset.reserve(suffix.size() + 1);
+    itemset.push_back(rank);
+    itemset.insert(itemset.end(), suffix.begin(), suffix.end());
+    _workers[workerIndex]->results.emplace_back(itemset, tree.rankSupports[rank]);
+
+    // Only ranks before the suffix item occur on its prefix paths.
+    std::vector<int> supports(rank, 0);
+    for(int node = tree.rankHeads[rank]; node >= 0; node = tree.nextNodes[node]) {
+        for(int parent = tree.parents[node]; parent > 0; parent = tree.parents[parent]) {
+            supports[tree.ranks[parent]] += tree.counts[node];
+        }
+    }
+
+    std::shared_ptr<Tree> conditional = std::make_shared<Tree>();
+    initTree(*conditional, rank);
+    std::vector<int> path;
+    for(int node = tree.rankHeads[rank]; node >= 0; node = tree.nextNodes[node]) {
+        path.clear();
+        for(int parent = tree.parents[node]; parent > 0; parent = tree.parents[parent]) {
+            if(supports[tree.ranks[parent]] >= _minCount) {
+                path.push_back(tree.ranks[parent]);
+            }
+        }
+
+        if(!path.empty()) {
+            std::reverse(path.begin(), path.end());
+            insertPath(*conditional, path, tree.counts[node]);
+        }
+    }
+
+    if(conditional->ranks.size() <= 1) {
+        return;
+    }
+
+    if(conditional->ranks.size() >= splitThreshold) {
+        Task task;
+        task.suffix = std::move(itemset);
+        task.tree = std::move(conditional);
+        task.rank = -1;
+        pushTask(workerIndex, std::move(task));
+    } else {
+        mineTree(workerIndex, conditional, itemset);
+    }
+}
+
+
+void ParallelFPGrowth::mineTree(const int workerIndex, const std::shared_ptr<const Tree> &tree, const std::vector<int> &suffix)
+{
+    TRACE_SCOPE_VALUE("mine conditional tree", "suffix", suffix.size());
+
+    for(int rank = 0; rank < static_cast<int>(tree->rankSupports.size()); rank++) {
+        if(tree->rankSupports[rank] >= _minCount) {
+            mineRank(workerIndex, *tree, rank, suffix);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef PARALLELFPGROWTH_H
+#define PARALLELFPGROWTH_H
+
+#include <QVector>
+#include <QMap>
+#include <QHash>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tracer.h"
+
+
+// Parallel FP-Growth. The ordered transactions are inserted into an FP-tree
+// that all workers read without locking. Every suffix item is one task that
+// builds its conditional FP-tree from the item's prefix paths and mines it;
+// conditional trees larger than a threshold are pushed back as new tasks
+// instead of being mined inline, so big subtrees are split further. Each
+// worker owns a deque, pops its newest task and steals the oldest one of
+// another worker when it runs dry. Results are kept per worker and merged
+// into one sorted map at the end, so the output does not depend on the
+// schedule.
+class ParallelFPGrowth
+{
+public:
+    // Constructors
+    ParallelFPGrowth(const QVector<int> &itemsOrder, const int threadsCount);
+
+    // Getters
+    int getTasksCount();
+    int getStolenCount();
+
+    // Functions
+    QMap<QVector<int>, int> mine(
+        const QVector<QVector<int>> &orderedTransactions,
+        const int minCount,
+        const QVector<int> &suffixItems
+    );
+
+private:
+    // FP-tree over item ranks. Nodes of one rank are chained through
+    // nextNodes starting at rankHeads; the root is node 0.
+    struct Tree
+    {
+        std::vector<int> ranks;
+        std::vector<int> parents;
+        std::vector<int> counts;
+        std::vector<int> firstChildren;
+        std::vector<int> nextSiblings;
+        std::vector<int> nextNodes;
+        std::vector<int> rankHeads;
+        std::vector<int> rankSupports;
+    };
+
+    struct Task
+    {
+        std::vector<int> suffix;
+        std::shared_ptr<const Tree> tree;
+        int rank;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::vector<std::pair<std::vector<int>, int>> results;
+    };
+
+    // Fields
+    QVector<int> _itemsOrder;
+    int _threadsCount;
+    int _minCount;
+    std::shared_ptr<const Tree> _tree;
+    std::vector<Worker*> _workers;
+    std::atomic<int> _pendingTasks;
+    std::atomic<int> _tasksCount;
+    std::atomic<int> _stolenCount;
+
+    // Functions
+    static void initTree(Tree &tree, const int ranksCount);
+    static void insertPath(Tree &tree, const std::vector<int> &path, const int count);
+    void work(const int workerIndex);
+    bool popTask(const int workerIndex, Task &task);
+    bool stealTask(const int workerIndex, Task &task);
+    void pushTask(const int workerIndex, Task &&task);
+    void mineRank(const int workerIndex, const Tree &tree, const int rank, const std::vector<int> &suffix);
+    void mineTree(const int workerIndex, const std::shared_ptr<const Tree> &tree, const std::vector<int> &suffix);
+};
+
+
+#endif // PARALLELFPGROWTH_H
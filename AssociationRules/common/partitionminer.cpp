@@ -0,0 +1,156 @@
+#include "partitionminer.h"
+
+
+PartitionMiner::PartitionMiner(const QString &filePath, const qint64 memoryBudget)
+{
+    _filePath = filePath;
+    _memoryBudget = memoryBudget;
+    _rangeBegin = 0;
+    _rangeEnd = -1;
+    _transactionsCount = 0;
+    _partitionsCount = 0;
+    _candidatesCount = 0;
+}
+
+
+int PartitionMiner::getTransactionsCount()
+{
+    return _transactionsCount;
+}
+
+
+int PartitionMiner::getPartitionsCount()
+{
+    return _partitionsCount;
+}
+
+
+int PartitionMiner::getCandidatesCount()
+{
+    return _candidatesCount;
+}
+
+
+QString PartitionMiner::getErrorString()
+{
+    return _errorString;
+}
+
+
+void PartitionMiner::setRange(const qint64 begin, const qint64 end)
+{
+    _rangeBegin = begin;
+    _rangeEnd = end;
+}
+
+
+bool PartitionMiner::mine(const double minSupport, QMap<QVector<int>, int> &frequentItemsets)
+{
+    PROFILE_SCOPE("mine");
+
+    _transactionsCount = 0;
+    _partitionsCount = 0;
+    _candidatesCount = 0;
+    frequentItemsets.clear();
+
+    TransactionReader reader(_filePath);
+    reader.setRange(_rangeBegin, _rangeEnd);
+    if(!reader.open()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    // Pass 1: local frequent itemsets of every partition.
+    QSet<QVector<int>> candidates;
+    QMap<QVector<int>, int> firstPartitionItemsets;
+    while(true) {
+        QVector<QVector<int>> partition;
+        if(!readPartition(reader, partition)) {
+            return false;
+        }
+        if(partition.isEmpty()) {
+            break;
+        }
+
+        _partitionsCount++;
+        _transactionsCount += partition.size();
+        TRACE_SCOPE_VALUE("partition", "index", _partitionsCount);
+
+        QMap<QVector<int>, int> localItemsets = Apriori::mine(partition, minSupport);
+        for(auto it = localItemsets.cbegin(); it != localItemsets.cend(); it++) {
+            candidates.insert(it.key());
+        }
+
+        if(_partitionsCount == 1) {
+            firstPartitionItemsets = localItemsets;
+        }
+    }
+    _candidatesCount = candidates.size();
+
+    // The whole input fitted in one partition, so local counts are global.
+    if(_partitionsCount <= 1) {
+        frequentItemsets = firstPartitionItemsets;
+        return true;
+    }
+
+    // Pass 2: exact global supports of the candidate union.
+    TRACE_SCOPE("global count");
+    CandidateTrie trie;
+    for(const QVector<int> &candidate : candidates) {
+        trie.insert(candidate);
+    }
+    candidates.clear();
+
+    if(!reader.rewind()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    QVector<int> transaction;
+    while(reader.next(transaction)) {
+        trie.count(Apriori::uniqueItems(transaction));
+    }
+    if(reader.hasError()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    int minCount = Apriori::minimumCount(minSupport, _transactionsCount);
+    QMap<QVector<int>, int> counts = trie.getCounts();
+    for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+        if(it.value() >= minCount) {
+            frequentItemsets[it.key()] = it.value();
+        }
+    }
+
+    return true;
+}
+
+
+bool PartitionMiner::readPartition(TransactionReader &reader, QVector<QVector<int>> &partition)
+{
+    // Half of the budget holds transactions, the rest is left for the local
+    // candidate levels mined from them.
+    qint64 partitionBudget = std::max<qint64>(1, _memoryBudget / 2);
+    qint64 footprint = 0;
+
+    QVector<int> transaction;
+    while(footprint < partitionBudget && reader.next(transaction)) {
+        footprint += transactionFootprint(transaction);
+        partition.append(transaction);
+    }
+
+    if(reader.hasError()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    return true;
+}
+
+
+qint64 PartitionMiner::transactionFootprint(const QVector<int> &transaction)
+{
+    // Vector handle, shared array header and the items themselves.
+    return sizeof(QVector<int>) + 16 + transaction.size() * sizeof(int);
+}
@@ -0,0 +1,53 @@
+#ifndef PARTITIONMINER_H
+#define PARTITIONMINER_H
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QSet>
+
+#include "apriori.h"
+#include "transactionreader.h"
+#include "profiler.h"
+
+
+// Out-of-core SON (Savasere, Omiecinski, Navathe) miner. The first pass reads
+// the input in partitions that fit the memory budget and mines each one at
+// the same relative support; the union of the local results is a superset of
+// the global answer, which the second streaming pass counts exactly.
+class PartitionMiner
+{
+public:
+    // Constructors
+    PartitionMiner(const QString &filePath, const qint64 memoryBudget);
+
+    // Getters
+    int getTransactionsCount();
+    int getPartitionsCount();
+    int getCandidatesCount();
+    QString getErrorString();
+
+    // Setters
+    void setRange(const qint64 begin, const qint64 end);
+
+    // Functions
+    bool mine(const double minSupport, QMap<QVector<int>, int> &frequentItemsets);
+
+private:
+    // Fields
+    QString _filePath;
+    qint64 _memoryBudget;
+    qint64 _rangeBegin;
+    qint64 _rangeEnd;
+    int _transactionsCount;
+    int _partitionsCount;
+    int _candidatesCount;
+    QString _errorString;
+
+    // Functions
+    bool readPartition(TransactionReader &reader, QVector<QVector<int>> &partition);
+    static qint64 transactionFootprint(const QVector<int> &transaction);
+};
+
+
+#endif // PARTITIONMINER_H
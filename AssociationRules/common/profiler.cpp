@@ -0,0 +1,242 @@
+#include "profiler.h"
+
+#include <cstring>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+
+struct ProfileEntry
+{
+    const char *name;
+    qint64 value;
+    qint64 calls;
+};
+
+
+static std::atomic<bool> profilerEnabled(false);
+static std::mutex profilerMutex;
+static QVector<ProfileEntry> profilePhases;
+static QVector<ProfileEntry> profileCounters;
+
+
+static void addEntry(QVector<ProfileEntry> &entries, const char *name, const qint64 value)
+{
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    for(ProfileEntry &entry : entries) {
+        if(entry.name == name || strcmp(entry.name, name) == 0) {
+            entry.value += value;
+            entry.calls++;
+            return;
+        }
+    }
+
+    entries.append({name, value, 1});
+}
+
+
+static QString formatMilliseconds(const qint64 nanoseconds)
+{
+    return QString::number(nanoseconds / 1e6, 'f', nanoseconds < 10000000 ? 2 : 0) + " ms";
+}
+
+
+static QString formatBytes(const qint64 bytes)
+{
+    if(bytes < 1024 * 1024) {
+        return QString::number(bytes / 1024.0, 'f', 1) + " KB";
+    }
+
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+}
+
+
+static QByteArray jsonString(const char *text)
+{
+    QByteArray escaped = "\"";
+    for(const char *c = text; *c; c++) {
+        if(*c == '"' || *c == '\\') {
+            escaped += '\\';
+        }
+        escaped += *c;
+    }
+
+    return escaped + "\"";
+}
+
+
+bool Profiler::isEnabled()
+{
+    return profilerEnabled.load(std::memory_order_relaxed);
+}
+
+
+qint64 Profiler::getPeakMemory()
+{
+    // Peak resident set size of the process so far, not of the current run.
+#if defined(__linux__) || defined(__APPLE__)
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return usage.ru_maxrss;
+#else
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+
+void Profiler::setEnabled(const bool enabled)
+{
+    profilerEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+void Profiler::reset()
+{
+    {
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        profilePhases.clear();
+        profileCounters.clear();
+    }
+
+    Tracer::reset();
+}
+
+
+void Profiler::addTime(const char *phase, const qint64 nanoseconds)
+{
+    addEntry(profilePhases, phase, nanoseconds);
+}
+
+
+void Profiler::addCount(const char *counter, const qint64 count)
+{
+    addEntry(profileCounters, counter, count);
+}
+
+
+QString Profiler::summary()
+{
+    std::lock_guard<std::mutex> lock(profilerMutex);
+
+    QStringList parts;
+    for(const ProfileEntry &phase : profilePhases) {
+        parts.append(QString(phase.name) + " " + formatMilliseconds(phase.value));
+    }
+    qint64 peakMemory = getPeakMemory();
+    if(peakMemory > 0) {
+        parts.append("peak RSS " + formatBytes(peakMemory));
+    }
+
+    return parts.join(", ");
+}
+
+
+QString Profiler::report()
+{
+    std::lock_guard<std::mutex> lock(profilerMutex);
+
+    QString text = "Phases:\n";
+    qint64 total = 0;
+    for(const ProfileEntry &phase : profilePhases) {
+        text += QString("  %1: %2").arg(phase.name).arg(formatMilliseconds(phase.value));
+        if(phase.calls > 1) {
+            text += QString(" (%1 calls)").arg(phase.calls);
+        }
+        text += "\n";
+        total += phase.value;
+    }
+    text += "  total: " + formatMilliseconds(total) + "\n";
+
+    if(!profileCounters.isEmpty()) {
+        text += "Counters:\n";
+        for(const ProfileEntry &counter : profileCounters) {
+            text += QString("  %1: %2\n").arg(counter.name).arg(counter.value);
+        }
+    }
+    text += "Peak RSS: " + formatBytes(getPeakMemory());
+
+    return text;
+}
+
+
+QByteArray Profiler::toJson()
+{
+    std::lock_guard<std::mutex> lock(profilerMutex);
+
+    QByteArray json = "{\n  \"phases\": [";
+    for(int i = 0; i < profilePhases.size(); i++) {
+        const ProfileEntry &phase = profilePhases[i];
+        json += (i > 0 ? ",\n    " : "\n    ");
+        json += "{\"name\": " + jsonString(phase.name)
+            + ", \"calls\": " + QByteArray::number(phase.calls)
+            + ", \"nanoseconds\": " + QByteArray::number(phase.value) + "}";
+    }
+    json += profilePhases.isEmpty() ? "],\n" : "\n  ],\n";
+
+    json += "  \"counters\": {";
+    for(int i = 0; i < profileCounters.size(); i++) {
+        json += (i > 0 ? ",\n    " : "\n    ");
+        json += jsonString(profileCounters[i].name) + ": " + QByteArray::number(profileCounters[i].value);
+    }
+    json += profileCounters.isEmpty() ? "},\n" : "\n  },\n";
+
+    json += "  \"peakRssBytes\": " + QByteArray::number(getPeakMemory()) + "\n}\n";
+
+    return json;
+}
+
+
+bool Profiler::writeJson(const QString &filePath, QString &errorString)
+{
+    QByteArray json = toJson();
+
+    if(filePath == "-") {
+        QFile file;
+        if(!file.open(stderr, QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            errorString = "Unable to write the profile";
+            return false;
+        }
+        return true;
+    }
+
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+        errorString = "Unable to write the profile file " + filePath;
+        return false;
+    }
+
+    return true;
+}
+
+
+ScopedTimer::ScopedTimer(const char *phase)
+{
+    _phase = phase;
+    _active = Profiler::isEnabled();
+    _traced = Tracer::isEnabled();
+    if(_traced) {
+        Tracer::begin(phase);
+    }
+    if(_active) {
+        _start = std::chrono::steady_clock::now();
+    }
+}
+
+
+ScopedTimer::~ScopedTimer()
+{
+    if(_active) {
+        auto elapsed = std::chrono::steady_clock::now() - _start;
+        Profiler::addTime(_phase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    if(_traced) {
+        Tracer::end(_phase);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <QStringList>
+#include <QFile>
+#include <QSaveFile>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "tracer.h"
+
+
+// Per-phase timings and counters of one run, shared by the tabs and the
+// command line. A phase is timed by a ScopedTimer over its block and a
+// counter is a running sum; both are kept in the order they first appear
+// and identified by their name, so the same phase in two places adds up.
+//
+// Recording happens only through the PROFILE_SCOPE and PROFILE_COUNT macros.
+// They cost one relaxed load while the profiler is disabled at run time, and
+// nothing at all in builds configured with ARULES_PROFILING off, where they
+// expand to no code. Phases are coarse (a read, a counting pass), so the
+// mutex taken on record is never contended in practice. reset() clears the
+// Tracer's events as well.
+class Profiler
+{
+public:
+    // Getters
+    static bool isEnabled();
+    static qint64 getPeakMemory();
+
+    // Setters
+    static void setEnabled(const bool enabled);
+
+    // Functions
+    static void reset();
+    static void addTime(const char *phase, const qint64 nanoseconds);
+    static void addCount(const char *counter, const qint64 count);
+    static QString summary();
+    static QString report();
+    static QByteArray toJson();
+    static bool writeJson(const QString &filePath, QString &errorString);
+};
+
+
+// Adds the time between its construction and destruction to a phase, and
+// brackets it with trace events while the tracer is enabled.
+class ScopedTimer
+{
+public:
+    // Constructors
+    ScopedTimer(const char *phase);
+    ~ScopedTimer();
+
+private:
+    // Fields
+    const char *_phase;
+    bool _active;
+    bool _traced;
+    std::chrono::steady_clock::time_point _start;
+};
+
+
+#ifdef ARULES_PROFILING
+#define PROFILE_SCOPE(phase) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)(phase)
+#define PROFILE_COUNT(counter, count) \
+    do { if(Profiler::isEnabled()) Profiler::addCount(counter, count); } while(0)
+#else
+#define PROFILE_SCOPE(phase) do {} while(0)
+#define PROFILE_COUNT(counter, count) do {} while(0)
+#endif
+
+
+#endif // PROFILER_H
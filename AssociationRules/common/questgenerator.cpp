@@ -0,0 +1,382 @@
+#include "questgenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+
+// Output is written in blocks of this many bytes.
+static const int writeBlockSize = 1 << 20;
+
+// Quest defaults: mean fraction of a pattern taken from the previous one,
+// and mean and deviation of the per-pattern corruption level.
+static const double patternCorrelation = 0.5;
+static const double corruptionMean = 0.5;
+static const double corruptionDeviation = 0.1;
+
+// Above this mean a Poisson variable is drawn from its normal approximation.
+static const double poissonNormalLimit = 30;
+
+static const double twoPi = 6.283185307179586;
+
+
+QuestGenerator::QuestGenerator(
+    const Model model,
+    const qint64 transactionsCount,
+    const double averageSize,
+    const int itemsCount,
+    const quint64 seed
+)
+{
+    _model = model;
+    _transactionsCount = std::max<qint64>(0, transactionsCount);
+    _averageSize = std::max(1.0, averageSize);
+    _itemsCount = std::max(1, itemsCount);
+    _seed = seed;
+    _patternsCount = 2000;
+    _averagePatternSize = 4;
+    _skew = 1;
+    _bytesWritten = 0;
+    _valuesCount = 0;
+}
+
+
+qint64 QuestGenerator::getBytesWritten()
+{
+    return _bytesWritten;
+}
+
+
+QString QuestGenerator::getErrorString()
+{
+    return _errorString;
+}
+
+
+void QuestGenerator::setPatterns(const int patternsCount, const double averagePatternSize)
+{
+    _patternsCount = std::max(1, patternsCount);
+    _averagePatternSize = std::max(1.0, averagePatternSize);
+}
+
+
+void QuestGenerator::setSkew(const double skew)
+{
+    _skew = std::max(0.0, skew);
+}
+
+
+bool QuestGenerator::generate(const QString &filePath)
+{
+    PROFILE_SCOPE("generate");
+
+    _bytesWritten = 0;
+
+    QFile standardOutput;
+    QSaveFile file(filePath);
+    QFileDevice *device = &file;
+    bool opened;
+    if(filePath == "-") {
+        opened = standardOutput.open(stdout, QIODevice::WriteOnly);
+        device = &standardOutput;
+    } else {
+        opened = file.open(QIODevice::WriteOnly);
+    }
+    if(!opened) {
+        _errorString = "Unable to open the output file " + filePath;
+        return false;
+    }
+
+    // Every run starts from the seed, so the same parameters give the same file.
+    _generator.seed(_seed);
+    buildModel();
+
+    QByteArray buffer;
+    buffer.reserve(writeBlockSize + 4096);
+    QVector<int> transaction;
+    for(qint64 t = 0; t < _transactionsCount; t++) {
+        nextTransaction(transaction);
+        appendTransaction(buffer, transaction);
+        if(buffer.size() >= writeBlockSize && !writeBlock(device, buffer)) {
+            return false;
+        }
+    }
+    if(!writeBlock(device, buffer)) {
+        return false;
+    }
+
+    if(device == &file && !file.commit()) {
+        _errorString = "Unable to write the output file " + filePath;
+        return false;
+    }
+    PROFILE_COUNT("bytes written", _bytesWritten);
+
+    return true;
+}
+
+
+void QuestGenerator::buildModel()
+{
+    _patterns.clear();
+    _attributeDominance.clear();
+    _deferredPattern.clear();
+
+    if(_model == Quest) {
+        // Each pattern takes part of its items from the previous one, so
+        // patterns overlap the way frequent itemsets of real data do.
+        QVector<double> weights;
+        for(int p = 0; p < _patternsCount; p++) {
+            Pattern pattern;
+            int size = std::min(_itemsCount, std::max(1, poisson(_averagePatternSize)));
+
+            if(p > 0) {
+                const QVector<int> &previous = _patterns.last().items;
+                double fraction = std::min(1.0, exponential(patternCorrelation));
+                int sharedCount = std::min<int>(previous.size(), std::lround(fraction * size));
+                for(int i = 0; i < sharedCount; i++) {
+                    int item = previous[static_cast<int>(uniform() * previous.size())];
+                    if(!pattern.items.contains(item)) {
+                        pattern.items.append(item);
+                    }
+                }
+            }
+            while(pattern.items.size() < size) {
+                int item = randomItem();
+                if(!pattern.items.contains(item)) {
+                    pattern.items.append(item);
+                }
+            }
+
+            pattern.corruption = std::clamp(normal(corruptionMean, corruptionDeviation), 0.0, 1.0);
+            _patterns.append(pattern);
+            weights.append(exponential(1));
+        }
+        buildAliasTable(weights, _patternTable);
+    } else if(_model == Dense) {
+        // T attributes of N / T values each, with one dominant value.
+        int attributesCount = std::min<int>(std::lround(_averageSize), std::max(1, _itemsCount / 2));
+        _valuesCount = std::max(2, _itemsCount / attributesCount);
+        for(int attribute = 0; attribute < attributesCount; attribute++) {
+            _attributeDominance.append(0.5 + 0.45 * uniform());
+        }
+    } else {
+        QVector<double> weights;
+        for(int rank = 1; rank <= _itemsCount; rank++) {
+            weights.append(1 / std::pow(rank, _skew));
+        }
+        buildAliasTable(weights, _itemTable);
+    }
+}
+
+
+void QuestGenerator::nextTransaction(QVector<int> &transaction)
+{
+    transaction.clear();
+
+    if(_model == Quest) {
+        nextQuestTransaction(transaction);
+    } else if(_model == Dense) {
+        nextDenseTransaction(transaction);
+    } else {
+        nextLongTailTransaction(transaction);
+    }
+
+    std::sort(transaction.begin(), transaction.end());
+    transaction.erase(std::unique(transaction.begin(), transaction.end()), transaction.end());
+}
+
+
+void QuestGenerator::nextQuestTransaction(QVector<int> &transaction)
+{
+    int size = std::max(1, poisson(_averageSize));
+
+    while(transaction.size() < size) {
+        int begin = transaction.size();
+        if(!_deferredPattern.isEmpty()) {
+            transaction += _deferredPattern;
+            _deferredPattern.clear();
+        } else {
+            // The pattern is corrupted in place at the end of the transaction.
+            const Pattern &pattern = _patterns[pick(_patternTable)];
+            transaction += pattern.items;
+            while(transaction.size() > begin && uniform() < pattern.corruption) {
+                int position = begin + static_cast<int>(uniform() * (transaction.size() - begin));
+                transaction[position] = transaction.last();
+                transaction.removeLast();
+            }
+        }
+
+        // A pattern that does not fit goes in anyway half of the time and
+        // opens the next transaction otherwise.
+        if(begin > 0 && transaction.size() > size) {
+            if(uniform() >= 0.5) {
+                _deferredPattern = transaction.mid(begin);
+                transaction.resize(begin);
+            }
+            break;
+        }
+    }
+}
+
+
+void QuestGenerator::nextDenseTransaction(QVector<int> &transaction)
+{
+    for(int attribute = 0; attribute < _attributeDominance.size(); attribute++) {
+        int value = 0;
+        if(uniform() >= _attributeDominance[attribute]) {
+            value = 1 + static_cast<int>(uniform() * (_valuesCount - 1));
+        }
+        transaction.append(attribute * _valuesCount + value + 1);
+    }
+}
+
+
+void QuestGenerator::nextLongTailTransaction(QVector<int> &transaction)
+{
+    int size = std::min(_itemsCount, std::max(1, poisson(_averageSize)));
+
+    // Draws are bounded, so a steep skew over few items cannot loop for long.
+    for(int draws = 0; transaction.size() < size && draws < 8 * size; draws++) {
+        int item = pick(_itemTable) + 1;
+        if(!transaction.contains(item)) {
+            transaction.append(item);
+        }
+    }
+}
+
+
+double QuestGenerator::uniform()
+{
+    return (_generator() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+double QuestGenerator::exponential(const double mean)
+{
+    return -mean * std::log(1 - uniform());
+}
+
+
+double QuestGenerator::normal(const double mean, const double deviation)
+{
+    // Box-Muller; 1 - u keeps the logarithm finite.
+    double radius = std::sqrt(-2 * std::log(1 - uniform()));
+
+    return mean + deviation * radius * std::cos(twoPi * uniform());
+}
+
+
+int QuestGenerator::poisson(const double mean)
+{
+    if(mean >= poissonNormalLimit) {
+        return std::max(0L, std::lround(normal(mean, std::sqrt(mean))));
+    }
+
+    // Inversion: walk the cumulative distribution up to one uniform number.
+    double value = uniform();
+    double probability = std::exp(-mean);
+    double cumulative = probability;
+    int count = 0;
+    while(value > cumulative && probability > 0) {
+        count++;
+        probability *= mean / count;
+        cumulative += probability;
+    }
+
+    return count;
+}
+
+
+int QuestGenerator::randomItem()
+{
+    return 1 + static_cast<int>(uniform() * _itemsCount);
+}
+
+
+int QuestGenerator::pick(const AliasTable &table)
+{
+    double scaled = uniform() * table.probabilities.size();
+    int index = std::min<int>(scaled, table.probabilities.size() - 1);
+
+    return scaled - index < table.probabilities[index] ? index : table.aliases[index];
+}
+
+
+void QuestGenerator::buildAliasTable(const QVector<double> &weights, AliasTable &table)
+{
+    int count = weights.size();
+    double weightsSum = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    table.probabilities.resize(count);
+    table.aliases.resize(count);
+
+    // Entries below the average weight are topped up by entries above it.
+    QVector<int> small;
+    QVector<int> large;
+    for(int i = 0; i < count; i++) {
+        table.probabilities[i] = weights[i] * count / weightsSum;
+        table.aliases[i] = i;
+        (table.probabilities[i] < 1 ? small : large).append(i);
+    }
+
+    while(!small.isEmpty() && !large.isEmpty()) {
+        int less = small.takeLast();
+        int more = large.last();
+        table.aliases[less] = more;
+        table.probabilities[more] -= 1 - table.probabilities[less];
+        if(table.probabilities[more] < 1) {
+            large.removeLast();
+            small.append(more);
+        }
+    }
+
+    // Rounding leaves the remaining entries at almost 1.
+    for(int i : small + large) {
+        table.probabilities[i] = 1;
+    }
+}
+
+
+void QuestGenerator::appendTransaction(QByteArray &buffer, const QVector<int> &transaction)
+{
+    // Room for the longest numbers is made up front and trimmed afterwards,
+    // so the digits go straight into the buffer.
+    int offset = buffer.size();
+    buffer.resize(offset + transaction.size() * 12 + 1);
+    char *out = buffer.data() + offset;
+
+    char digits[12];
+    for(int i = 0; i < transaction.size(); i++) {
+        if(i > 0) {
+            *out++ = ' ';
+        }
+
+        unsigned int value = transaction[i];
+        int length = 0;
+        do {
+            digits[length++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while(value > 0);
+        while(length > 0) {
+            *out++ = digits[--length];
+        }
+    }
+    *out++ = '\n';
+
+    buffer.resize(out - buffer.data());
+}
+
+
+bool QuestGenerator::writeBlock(QFileDevice *device, QByteArray &buffer)
+{
+    if(device->write(buffer) != buffer.size()) {
+        _errorString = "Unable to write the output file";
+        return false;
+    }
+
+    // resize() keeps the capacity, clear() would free it.
+    _bytesWritten += buffer.size();
+    buffer.resize(0);
+
+    return true;
+}
@@ -0,0 +1,114 @@
+#ifndef QUESTGENERATOR_H
+#define QUESTGENERATOR_H
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+
+#include <random>
+
+#include "profiler.h"
+
+
+// Synthetic transactions in the whitespace separated input format, with the
+// parameters of the IBM Quest generator (Agrawal, Srikant): D transactions of
+// average size T over N items, built from L potentially frequent patterns of
+// average size I.
+//
+// Quest follows the original model: patterns share an exponentially
+// distributed fraction of their items with the previous pattern, are picked
+// by an exponentially distributed weight and lose items to a per-pattern
+// corruption level. Dense gives every transaction one value of each of T
+// attributes, one value dominating per attribute, as in chess or mushroom.
+// LongTail draws the items of each transaction from a Zipf distribution.
+//
+// Random numbers come from mt19937_64, whose sequence the standard fixes, and
+// are shaped by hand instead of by the std distributions, which are left to
+// the implementation. The shaping still calls std::log, std::exp, std::cos
+// and std::pow, which are not correctly rounded, so a seed gives the same
+// file for the same standard and math library; across platforms (glibc,
+// MSVC, macOS) the files can differ.
+class QuestGenerator
+{
+public:
+    enum Model
+    {
+        Quest,
+        Dense,
+        LongTail
+    };
+
+    // Constructors
+    QuestGenerator(
+        const Model model,
+        const qint64 transactionsCount,
+        const double averageSize,
+        const int itemsCount,
+        const quint64 seed = 0
+    );
+
+    // Getters
+    qint64 getBytesWritten();
+    QString getErrorString();
+
+    // Setters
+    void setPatterns(const int patternsCount, const double averagePatternSize);
+    void setSkew(const double skew);
+
+    // Functions
+    bool generate(const QString &filePath);
+
+private:
+    struct Pattern
+    {
+        QVector<int> items;
+        double corruption;
+    };
+
+    // Walker's alias method: one uniform number picks an index in O(1).
+    struct AliasTable
+    {
+        QVector<double> probabilities;
+        QVector<int> aliases;
+    };
+
+    // Fields
+    Model _model;
+    qint64 _transactionsCount;
+    double _averageSize;
+    int _itemsCount;
+    quint64 _seed;
+    int _patternsCount;
+    double _averagePatternSize;
+    double _skew;
+    qint64 _bytesWritten;
+    QString _errorString;
+    std::mt19937_64 _generator;
+    QVector<Pattern> _patterns;
+    AliasTable _patternTable;
+    AliasTable _itemTable;
+    QVector<double> _attributeDominance;
+    QVector<int> _deferredPattern;
+    int _valuesCount;
+
+    // Functions
+    void buildModel();
+    void nextTransaction(QVector<int> &transaction);
+    void nextQuestTransaction(QVector<int> &transaction);
+    void nextDenseTransaction(QVector<int> &transaction);
+    void nextLongTailTransaction(QVector<int> &transaction);
+    double uniform();
+    double exponential(const double mean);
+    double normal(const double mean, const double deviation);
+    int poisson(const double mean);
+    int randomItem();
+    int pick(const AliasTable &table);
+    static void buildAliasTable(const QVector<double> &weights, AliasTable &table);
+    static void appendTransaction(QByteArray &buffer, const QVector<int> &transaction);
+    bool writeBlock(QFileDevice *device, QByteArray &buffer);
+};
+
+
+#endif // QUESTGENERATOR_H
@@ -0,0 +1,161 @@
+#include "rpgrowth.h"
+
+
+RPGrowth::RPGrowth()
+{
+    _treeTransactionsCount = 0;
+}
+
+
+int RPGrowth::getTreeTransactionsCount()
+{
+    return _treeTransactionsCount;
+}
+
+
+int RPGrowth::getNodesCount()
+{
+    return _nodes.size();
+}
+
+
+QMap<QVector<int>, int> RPGrowth::mine(
+    const QVector<QVector<int>> &transactions,
+    const double minRareSupport,
+    const double minFrequentSupport
+)
+{
+    int transactionsCount = transactions.size();
+    int minRareCount = std::max(1, int(std::ceil(minRareSupport * transactionsCount)));
+    int minFrequentCount = int(std::ceil(minFrequentSupport * transactionsCount));
+
+    QHash<int, int> itemsCounts;
+    for(const QVector<int> &transaction : transactions) {
+        for(int item : Apriori::uniqueItems(transaction)) {
+            itemsCounts[item]++;
+        }
+    }
+
+    // Rare items are less frequent than every frequent one, so in descending
+    // support order they close each path and FP-Growth suffixes start there.
+    auto ranksBefore = [&itemsCounts](const int a, const int b) {
+        int countA = itemsCounts.value(a);
+        int countB = itemsCounts.value(b);
+        if(countA == countB) {
+            return a < b;
+        }
+
+        return countA > countB;
+    };
+
+    _nodes.clear();
+    _nodes.append(Node{-1, 0, -1, {}, {}});
+    _itemsNodes.clear();
+    _treeTransactionsCount = 0;
+
+    for(const QVector<int> &transaction : transactions) {
+        QVector<int> path;
+        bool hasRareItem = false;
+        for(int item : Apriori::uniqueItems(transaction)) {
+            int count = itemsCounts.value(item);
+            if(count >= minRareCount) {
+                path.append(item);
+                hasRareItem = hasRareItem || count < minFrequentCount;
+            }
+        }
+
+        if(hasRareItem) {
+            std::sort(path.begin(), path.end(), ranksBefore);
+            insertPath(path);
+            _treeTransactionsCount++;
+        }
+    }
+
+    QMap<QVector<int>, int> rareItemsets;
+    for(auto it = _itemsNodes.cbegin(); it != _itemsNodes.cend(); it++) {
+        int item = it.key();
+        if(itemsCounts.value(item) >= minFrequentCount) {
+            continue;
+        }
+
+        rareItemsets[QVector<int>{item}] = itemsCounts.value(item);
+
+        QVector<QPair<QVector<int>, int>> base;
+        for(int node : it.value()) {
+            QVector<int> path;
+            for(int parent = _nodes[node].parent; parent > 0; parent = _nodes[parent].parent) {
+                path.prepend(_nodes[parent].item);
+            }
+
+            if(!path.isEmpty()) {
+                base.append(qMakePair(path, _nodes[node].count));
+            }
+        }
+
+        mineBase(base, QVector<int>{item}, minRareCount, rareItemsets);
+    }
+
+    return rareItemsets;
+}
+
+
+void RPGrowth::insertPath(const QVector<int> &path)
+{
+    int node = 0;
+    _nodes[node].count++;
+
+    for(int item : path) {
+        int position = _nodes[node].childItems.indexOf(item);
+        if(position >= 0) {
+            node = _nodes[node].children[position];
+        } else {
+            int child = _nodes.size();
+            _nodes.append(Node{item, 0, node, {}, {}});
+            _nodes[node].childItems.append(item);
+            _nodes[node].children.append(child);
+            _itemsNodes[item].append(child);
+            node = child;
+        }
+
+        _nodes[node].count++;
+    }
+}
+
+
+void RPGrowth::mineBase(
+    const QVector<QPair<QVector<int>, int>> &base,
+    const QVector<int> &suffix,
+    const int minCount,
+    QMap<QVector<int>, int> &rareItemsets
+)
+{
+    QHash<int, int> counts;
+    for(const auto &pair : base) {
+        for(int item : pair.first) {
+            counts[item] += pair.second;
+        }
+    }
+
+    for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+        if(it.value() < minCount) {
+            continue;
+        }
+
+        QVector<int> itemset = suffix;
+        itemset.append(it.key());
+        std::sort(itemset.begin(), itemset.end());
+        rareItemsets[itemset] = it.value();
+
+        QVector<QPair<QVector<int>, int>> conditionalBase;
+        for(const auto &pair : base) {
+            int position = pair.first.indexOf(it.key());
+            if(position > 0) {
+                conditionalBase.append(qMakePair(pair.first.mid(0, position), pair.second));
+            }
+        }
+
+        if(!conditionalBase.isEmpty()) {
+            mineBase(conditionalBase, itemset, minCount, rareItemsets);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef RPGROWTH_H
+#define RPGROWTH_H
+
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QPair>
+
+#include <cmath>
+
+#include "apriori.h"
+
+
+// RP-Growth rare pattern miner. Items whose support lies in
+// [minRareSupport, minFrequentSupport) are rare; items below minRareSupport
+// are treated as noise and dropped. Only transactions holding at least one
+// rare item are inserted into the RP-tree, and FP-Growth is started from the
+// rare items only, so the frequent-only part of the search space is never
+// visited. The result holds every itemset that contains a rare item and has
+// a support of at least minRareSupport, with its exact support.
+class RPGrowth
+{
+public:
+    // Constructors
+    RPGrowth();
+
+    // Getters
+    int getTreeTransactionsCount();
+    int getNodesCount();
+
+    // Functions
+    QMap<QVector<int>, int> mine(
+        const QVector<QVector<int>> &transactions,
+        const double minRareSupport,
+        const double minFrequentSupport
+    );
+
+private:
+    struct Node
+    {
+        int item;
+        int count;
+        int parent;
+        QVector<int> childItems;
+        QVector<int> children;
+    };
+
+    // Fields
+    QVector<Node> _nodes;
+    QHash<int, QVector<int>> _itemsNodes;
+    int _treeTransactionsCount;
+
+    // Functions
+    void insertPath(const QVector<int> &path);
+    void mineBase(
+        const QVector<QPair<QVector<int>, int>> &base,
+        const QVector<int> &suffix,
+        const int minCount,
+        QMap<QVector<int>, int> &rareItemsets
+    );
+};
+
+
+#endif // RPGROWTH_H
@@ -0,0 +1,281 @@
+#include "samplingminer.h"
+
+
+// Probability bound used to lower the support for the sample (Toivonen).
+static const double missProbability = 0.01;
+
+
+SamplingMiner::SamplingMiner(const QString &filePath, const int sampleSize, const quint64 seed)
+{
+    _filePath = filePath;
+    _sampleSize = std::max(1, sampleSize);
+    _seed = seed;
+    _transactionsCount = 0;
+    _sampleCount = 0;
+    _loweredSupport = 0;
+    _passesCount = 0;
+    _fallbackUsed = false;
+}
+
+
+int SamplingMiner::getTransactionsCount()
+{
+    return _transactionsCount;
+}
+
+
+int SamplingMiner::getSampleCount()
+{
+    return _sampleCount;
+}
+
+
+double SamplingMiner::getLoweredSupport()
+{
+    return _loweredSupport;
+}
+
+
+int SamplingMiner::getPassesCount()
+{
+    return _passesCount;
+}
+
+
+bool SamplingMiner::isFallbackUsed()
+{
+    return _fallbackUsed;
+}
+
+
+QString SamplingMiner::getErrorString()
+{
+    return _errorString;
+}
+
+
+bool SamplingMiner::mine(
+    const double minSupport,
+    QMap<QVector<int>, int> &frequentItemsets,
+    QMap<QVector<int>, int> &negativeBorder
+)
+{
+    PROFILE_SCOPE("mine");
+
+    frequentItemsets.clear();
+    negativeBorder.clear();
+    _passesCount = 0;
+    _fallbackUsed = false;
+
+    QVector<QVector<int>> sample;
+    if(!readSample(sample)) {
+        return false;
+    }
+    if(_transactionsCount == 0) {
+        return true;
+    }
+
+    // A sample holding the whole input is mined exactly, without a pass.
+    bool sampleIsInput = _sampleCount == _transactionsCount;
+    int minCount = Apriori::minimumCount(minSupport, _transactionsCount);
+
+    _loweredSupport = minSupport;
+    if(!sampleIsInput) {
+        double slack = std::sqrt(std::log(1 / missProbability) / (2.0 * _sampleCount));
+        _loweredSupport = std::max(minSupport / 2, minSupport - slack);
+    }
+
+    // The sample's frequent itemsets plus their negative border; single items
+    // are always counted, so only the larger levels need candidates.
+    QMap<QVector<int>, int> sampleItemsets = Apriori::mine(sample, _loweredSupport);
+    QVector<QVector<int>> candidates;
+    QMap<int, QVector<QVector<int>>> levels = splitLevels(sampleItemsets.keys().toVector());
+    for(auto it = levels.cbegin(); it != levels.cend(); it++) {
+        candidates += Apriori::generateCandidates(it.value());
+    }
+
+    QMap<QVector<int>, int> counts;
+    if(!countPass(candidates, sample, sampleIsInput, counts)) {
+        return false;
+    }
+
+    QVector<QVector<int>> frequent;
+    for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+        if(it.value() >= minCount) {
+            frequent.append(it.key());
+            _fallbackUsed = _fallbackUsed || !sampleItemsets.contains(it.key());
+        }
+    }
+
+    // A frequent border itemset means supersets of it may have been missed.
+    if(_fallbackUsed) {
+        QVector<QVector<int>> missed = closure(frequent, counts);
+        if(!missed.isEmpty()) {
+            QMap<QVector<int>, int> missedCounts;
+            if(!countPass(missed, sample, sampleIsInput, missedCounts)) {
+                return false;
+            }
+
+            for(const QVector<int> &itemset : missed) {
+                counts[itemset] = missedCounts.value(itemset);
+            }
+        }
+    }
+
+    for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+        if(it.value() >= minCount) {
+            frequentItemsets[it.key()] = it.value();
+        }
+    }
+
+    for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+        if(it.value() >= minCount) {
+            continue;
+        }
+
+        bool minimal = true;
+        for(int removePos = 0; removePos < it.key().size() && minimal && it.key().size() > 1; removePos++) {
+            QVector<int> subset = it.key();
+            subset.removeAt(removePos);
+            minimal = frequentItemsets.contains(subset);
+        }
+
+        if(minimal) {
+            negativeBorder[it.key()] = it.value();
+        }
+    }
+
+    return true;
+}
+
+
+bool SamplingMiner::readSample(QVector<QVector<int>> &sample)
+{
+    sample.clear();
+    _transactionsCount = 0;
+    _sampleCount = 0;
+
+    TransactionReader reader(_filePath);
+    if(!reader.open()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    // Reservoir sampling keeps a uniform sample without knowing the size.
+    std::mt19937_64 generator(_seed);
+    QVector<int> transaction;
+    while(reader.next(transaction)) {
+        if(_transactionsCount < _sampleSize) {
+            sample.append(Apriori::uniqueItems(transaction));
+        } else {
+            std::uniform_int_distribution<qint64> distribution(0, _transactionsCount);
+            qint64 position = distribution(generator);
+            if(position < _sampleSize) {
+                sample[position] = Apriori::uniqueItems(transaction);
+            }
+        }
+        _transactionsCount++;
+    }
+    if(reader.hasError()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    _sampleCount = sample.size();
+
+    return true;
+}
+
+
+bool SamplingMiner::countPass(
+    const QVector<QVector<int>> &candidates,
+    const QVector<QVector<int>> &sample,
+    const bool sampleIsInput,
+    QMap<QVector<int>, int> &counts
+)
+{
+    TRACE_SCOPE("counting pass");
+
+    counts.clear();
+
+    CandidateTrie trie;
+    for(const QVector<int> &candidate : candidates) {
+        trie.insert(candidate);
+    }
+
+    QHash<int, int> itemCounts;
+    auto countTransaction = [&](const QVector<int> &items) {
+        for(int item : items) {
+            itemCounts[item]++;
+        }
+        trie.count(items);
+    };
+
+    if(sampleIsInput) {
+        for(const QVector<int> &transaction : sample) {
+            countTransaction(transaction);
+        }
+    } else {
+        TransactionReader reader(_filePath);
+        if(!reader.open()) {
+            _errorString = reader.getErrorString();
+            return false;
+        }
+
+        QVector<int> transaction;
+        while(reader.next(transaction)) {
+            countTransaction(Apriori::uniqueItems(transaction));
+        }
+        if(reader.hasError()) {
+            _errorString = reader.getErrorString();
+            return false;
+        }
+
+        _passesCount++;
+    }
+
+    if(!candidates.isEmpty()) {
+        counts = trie.getCounts();
+    }
+    for(auto it = itemCounts.cbegin(); it != itemCounts.cend(); it++) {
+        counts[QVector<int>{it.key()}] = it.value();
+    }
+
+    return true;
+}
+
+
+QMap<int, QVector<QVector<int>>> SamplingMiner::splitLevels(const QVector<QVector<int>> &itemsets)
+{
+    QMap<int, QVector<QVector<int>>> levels;
+    for(const QVector<int> &itemset : itemsets) {
+        levels[itemset.size()].append(itemset);
+    }
+
+    return levels;
+}
+
+
+QVector<QVector<int>> SamplingMiner::closure(
+    const QVector<QVector<int>> &itemsets,
+    const QMap<QVector<int>, int> &counted
+)
+{
+    TRACE_SCOPE("closure");
+
+    // Every uncounted itemset whose subsets are frequent or themselves
+    // uncounted could be frequent, so all of them go to the second pass.
+    QMap<int, QVector<QVector<int>>> levels = splitLevels(itemsets);
+    QVector<QVector<int>> uncounted;
+
+    for(int size = 1; levels.contains(size); size++) {
+        for(const QVector<int> &candidate : Apriori::generateCandidates(levels.value(size))) {
+            if(!counted.contains(candidate)) {
+                uncounted.append(candidate);
+                levels[size + 1].append(candidate);
+            }
+        }
+    }
+
+    return uncounted;
+}
@@ -0,0 +1,75 @@
+#ifndef SAMPLINGMINER_H
+#define SAMPLINGMINER_H
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+
+#include <random>
+
+#include "apriori.h"
+#include "transactionreader.h"
+#include "profiler.h"
+
+
+// Toivonen's sampling miner. A uniform sample of the input is mined in
+// memory at a lowered support; the sample's frequent itemsets and their
+// negative border are then counted exactly in one streaming pass. If no
+// border itemset turns out frequent the result is exact. Otherwise the
+// closure of the possibly missed itemsets is counted in a second pass, which
+// is reported through isFallbackUsed().
+//
+// Besides the frequent itemsets, mine() returns the negative border of the
+// result, i.e. the minimal rare itemsets, with their exact supports.
+class SamplingMiner
+{
+public:
+    // Constructors
+    SamplingMiner(const QString &filePath, const int sampleSize, const quint64 seed = 0);
+
+    // Getters
+    int getTransactionsCount();
+    int getSampleCount();
+    double getLoweredSupport();
+    int getPassesCount();
+    bool isFallbackUsed();
+    QString getErrorString();
+
+    // Functions
+    bool mine(
+        const double minSupport,
+        QMap<QVector<int>, int> &frequentItemsets,
+        QMap<QVector<int>, int> &negativeBorder
+    );
+
+private:
+    // Fields
+    QString _filePath;
+    int _sampleSize;
+    quint64 _seed;
+    int _transactionsCount;
+    int _sampleCount;
+    double _loweredSupport;
+    int _passesCount;
+    bool _fallbackUsed;
+    QString _errorString;
+
+    // Functions
+    bool readSample(QVector<QVector<int>> &sample);
+    bool countPass(
+        const QVector<QVector<int>> &candidates,
+        const QVector<QVector<int>> &sample,
+        const bool sampleIsInput,
+        QMap<QVector<int>, int> &counts
+    );
+    static QMap<int, QVector<QVector<int>>> splitLevels(const QVector<QVector<int>> &itemsets);
+    static QVector<QVector<int>> closure(
+        const QVector<QVector<int>> &itemsets,
+        const QMap<QVector<int>, int> &counted
+    );
+};
+
+
+#endif // SAMPLINGMINER_H
@@ -0,0 +1,301 @@
+#include "slidingwindowtree.h"
+
+
+SlidingWindowTree::SlidingWindowTree(const int windowSize)
+{
+    _windowSize = std::max(1, windowSize);
+    _windowStart = 0;
+    _transactionsCount = 0;
+    _nodesCount = 0;
+    _updatesSinceCheck = 0;
+    _restructuresCount = 0;
+
+    _nodes.append({-1, 0, -1, {}, {}});
+}
+
+
+int SlidingWindowTree::getTransactionsCount()
+{
+    return _transactionsCount;
+}
+
+
+int SlidingWindowTree::getNodesCount()
+{
+    return _nodesCount;
+}
+
+
+int SlidingWindowTree::getRestructuresCount()
+{
+    return _restructuresCount;
+}
+
+
+QMap<QVector<int>, int> SlidingWindowTree::getFrequentItemsets(const double minSupport)
+{
+    QMap<QVector<int>, int> frequentItemsets;
+    int minCount = std::max(1, Apriori::minimumCount(minSupport, _transactionsCount));
+
+    for(auto it = _itemsNodes.cbegin(); it != _itemsNodes.cend(); it++) {
+        int item = it.key();
+        if(_itemsFrequencies.value(item) < minCount) {
+            continue;
+        }
+
+        frequentItemsets[QVector<int>{item}] = _itemsFrequencies.value(item);
+
+        // Prefix paths of every node of the item form its conditional base.
+        QVector<QPair<QVector<int>, int>> base;
+        for(int node : it.value()) {
+            QVector<int> path;
+            for(int parent = _nodes[node].parent; parent > 0; parent = _nodes[parent].parent) {
+                path.prepend(_nodes[parent].item);
+            }
+
+            if(!path.isEmpty()) {
+                base.append(qMakePair(path, _nodes[node].count));
+            }
+        }
+
+        mineBase(base, QVector<int>{item}, minCount, frequentItemsets);
+    }
+
+    return frequentItemsets;
+}
+
+
+void SlidingWindowTree::add(const QVector<int> &transaction)
+{
+    QVector<int> items = Apriori::uniqueItems(transaction);
+
+    if(_transactionsCount == _windowSize) {
+        removePath(orderItems(_window[_windowStart]));
+        _window[_windowStart] = items;
+        _windowStart = (_windowStart + 1) % _windowSize;
+    } else {
+        _window.append(items);
+        _transactionsCount++;
+    }
+
+    insertPath(orderItems(items), 1);
+
+    // Checking the order once per window keeps restructuring amortized O(1)
+    // per transaction.
+    _updatesSinceCheck++;
+    if(_updatesSinceCheck >= _windowSize) {
+        _updatesSinceCheck = 0;
+        if(orderDrifted()) {
+            restructure();
+        }
+    }
+}
+
+
+QVector<int> SlidingWindowTree::orderItems(const QVector<int> &transaction)
+{
+    // Items seen for the first time go after all known ones until the next
+    // restructure ranks them by frequency.
+    QVector<int> ordered = transaction;
+    for(int item : ordered) {
+        if(!_itemsRanks.contains(item)) {
+            _itemsRanks.insert(item, _itemsRanks.size());
+        }
+    }
+
+    std::sort(ordered.begin(), ordered.end(),
+        [this](const int a, const int b) {
+            return _itemsRanks.value(a) < _itemsRanks.value(b);
+        }
+    );
+
+    return ordered;
+}
+
+
+void SlidingWindowTree::insertPath(const QVector<int> &path, const int count)
+{
+    int node = 0;
+    _nodes[node].count += count;
+
+    for(int item : path) {
+        int child = findChild(node, item);
+        if(child < 0) {
+            child = createNode(node, item);
+        }
+
+        _nodes[child].count += count;
+        _itemsFrequencies[item] += count;
+        node = child;
+    }
+}
+
+
+void SlidingWindowTree::removePath(const QVector<int> &path)
+{
+    int node = 0;
+    _nodes[node].count--;
+
+    QVector<int> visited;
+    for(int item : path) {
+        node = findChild(node, item);
+        _nodes[node].count--;
+        visited.append(node);
+
+        if(--_itemsFrequencies[item] == 0) {
+            _itemsFrequencies.remove(item);
+        }
+    }
+
+    // Counts never grow towards the leaves, so emptied nodes form a suffix.
+    for(int i = visited.size() - 1; i >= 0 && _nodes[visited[i]].count == 0; i--) {
+        releaseNode(visited[i]);
+    }
+}
+
+
+int SlidingWindowTree::findChild(const int node, const int item)
+{
+    const QVector<int> &items = _nodes[node].childItems;
+    auto position = std::lower_bound(items.begin(), items.end(), item);
+    if(position == items.end() || *position != item) {
+        return -1;
+    }
+
+    return _nodes[node].children[position - items.begin()];
+}
+
+
+int SlidingWindowTree::createNode(const int parent, const int item)
+{
+    int node;
+    if(_freeNodes.isEmpty()) {
+        node = _nodes.size();
+        _nodes.append({item, 0, parent, {}, {}});
+    } else {
+        node = _freeNodes.takeLast();
+        _nodes[node] = {item, 0, parent, {}, {}};
+    }
+
+    QVector<int> &items = _nodes[parent].childItems;
+    int index = std::lower_bound(items.begin(), items.end(), item) - items.begin();
+    items.insert(index, item);
+    _nodes[parent].children.insert(index, node);
+
+    _itemsNodes[item].insert(node);
+    _nodesCount++;
+
+    return node;
+}
+
+
+void SlidingWindowTree::releaseNode(const int node)
+{
+    int item = _nodes[node].item;
+    Node &parent = _nodes[_nodes[node].parent];
+    int index = std::lower_bound(parent.childItems.begin(), parent.childItems.end(), item) - parent.childItems.begin();
+    parent.childItems.removeAt(index);
+    parent.children.removeAt(index);
+
+    QSet<int> &itemNodes = _itemsNodes[item];
+    itemNodes.remove(node);
+    if(itemNodes.isEmpty()) {
+        _itemsNodes.remove(item);
+    }
+
+    _freeNodes.append(node);
+    _nodesCount--;
+}
+
+
+bool SlidingWindowTree::orderDrifted()
+{
+    QVector<int> items = _itemsFrequencies.keys().toVector();
+    std::sort(items.begin(), items.end(),
+        [this](const int a, const int b) {
+            return _itemsRanks.value(a) < _itemsRanks.value(b);
+        }
+    );
+
+    for(int i = 1; i < items.size(); i++) {
+        if(_itemsFrequencies.value(items[i - 1]) < _itemsFrequencies.value(items[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void SlidingWindowTree::restructure()
+{
+    QVector<int> items = _itemsFrequencies.keys().toVector();
+    std::sort(items.begin(), items.end(),
+        [this](const int a, const int b) {
+            int frequencyA = _itemsFrequencies.value(a);
+            int frequencyB = _itemsFrequencies.value(b);
+            if(frequencyA == frequencyB) {
+                return a < b;
+            }
+
+            return frequencyA > frequencyB;
+        }
+    );
+
+    _itemsRanks.clear();
+    for(int rank = 0; rank < items.size(); rank++) {
+        _itemsRanks.insert(items[rank], rank);
+    }
+
+    _nodes.resize(1);
+    _nodes[0] = {-1, 0, -1, {}, {}};
+    _freeNodes.clear();
+    _nodesCount = 0;
+    _itemsNodes.clear();
+    _itemsFrequencies.clear();
+
+    for(const QVector<int> &transaction : _window) {
+        insertPath(orderItems(transaction), 1);
+    }
+
+    _restructuresCount++;
+}
+
+
+void SlidingWindowTree::mineBase(
+    const QVector<QPair<QVector<int>, int>> &base,
+    const QVector<int> &suffix,
+    const int minCount,
+    QMap<QVector<int>, int> &frequentItemsets
+)
+{
+    QHash<int, int> counts;
+    for(const auto &pair : base) {
+        for(int item : pair.first) {
+            counts[item] += pair.second;
+        }
+    }
+
+    for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+        if(it.value() < minCount) {
+            continue;
+        }
+
+        QVector<int> itemset = suffix;
+        itemset.append(it.key());
+        std::sort(itemset.begin(), itemset.end());
+        frequentItemsets[itemset] = it.value();
+
+        QVector<QPair<QVector<int>, int>> conditionalBase;
+        for(const auto &pair : base) {
+            int position = pair.first.indexOf(it.key());
+            if(position > 0) {
+                conditionalBase.append(qMakePair(pair.first.mid(0, position), pair.second));
+            }
+        }
+
+        if(!conditionalBase.isEmpty()) {
+            mineBase(conditionalBase, itemset, minCount, frequentItemsets);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef SLIDINGWINDOWTREE_H
+#define SLIDINGWINDOWTREE_H
+
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+
+#include "apriori.h"
+
+
+// Prefix tree over the last windowSize transactions (CPS-tree style). Adding
+// a transaction inserts its path and, once the window is full, removes the
+// path of the expiring one, both in O(transaction length). Paths follow an
+// item order that is only brought back to descending frequency lazily: once
+// per window of updates the order is compared with the current frequencies
+// and the tree is restructured only if they disagree. Frequent itemsets of
+// the current window can be queried at any time by FP-Growth over the tree.
+class SlidingWindowTree
+{
+public:
+    // Constructors
+    SlidingWindowTree(const int windowSize);
+
+    // Getters
+    int getTransactionsCount();
+    int getNodesCount();
+    int getRestructuresCount();
+    QMap<QVector<int>, int> getFrequentItemsets(const double minSupport);
+
+    // Functions
+    void add(const QVector<int> &transaction);
+
+private:
+    struct Node
+    {
+        int item;
+        int count;
+        int parent;
+        QVector<int> childItems;
+        QVector<int> children;
+    };
+
+    // Fields
+    int _windowSize;
+    QVector<QVector<int>> _window;
+    int _windowStart;
+    int _transactionsCount;
+    QVector<Node> _nodes;
+    QVector<int> _freeNodes;
+    int _nodesCount;
+    QHash<int, int> _itemsFrequencies;
+    QHash<int, int> _itemsRanks;
+    QHash<int, QSet<int>> _itemsNodes;
+    int _updatesSinceCheck;
+    int _restructuresCount;
+
+    // Functions
+    QVector<int> orderItems(const QVector<int> &transaction);
+    void insertPath(const QVector<int> &path, const int count);
+    void removePath(const QVector<int> &path);
+    int findChild(const int node, const int item);
+    int createNode(const int parent, const int item);
+    void releaseNode(const int node);
+    bool orderDrifted();
+    void restructure();
+    void mineBase(
+        const QVector<QPair<QVector<int>, int>> &base,
+        const QVector<int> &suffix,
+        const int minCount,
+        QMap<QVector<int>, int> &frequentItemsets
+    );
+};
+
+
+#endif // SLIDINGWINDOWTREE_H
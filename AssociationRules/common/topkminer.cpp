@@ -0,0 +1,243 @@
+#include "topkminer.h"
+
+
+TopKMiner::TopKMiner(const QVector<QVector<int>> &transactions)
+{
+    _transactionsCount = transactions.size();
+    _k = 0;
+
+    QHash<int, QVector<int>> tidLists;
+    for(int tid = 0; tid < transactions.size(); tid++) {
+        int previous = 0;
+        QVector<int> items = transactions[tid];
+        std::sort(items.begin(), items.end());
+        for(int i = 0; i < items.size(); i++) {
+            if(i > 0 && items[i] == previous) {
+                continue;
+            }
+            tidLists[items[i]].append(tid);
+            previous = items[i];
+        }
+    }
+
+    _items = tidLists.keys().toVector();
+    std::sort(_items.begin(), _items.end(),
+        [&tidLists](const int a, const int b) {
+            int supportA = tidLists.value(a).size();
+            int supportB = tidLists.value(b).size();
+            if(supportA == supportB) {
+                return a < b;
+            }
+
+            return supportA > supportB;
+        }
+    );
+
+    for(int item : _items) {
+        _tidLists.append(tidLists.value(item));
+    }
+}
+
+
+int TopKMiner::getMinCount()
+{
+    return threshold();
+}
+
+
+QMap<QVector<int>, int> TopKMiner::mineFrequent(const int k)
+{
+    _k = k;
+    _bestSupports = {};
+    _found.clear();
+    if(_k <= 0) {
+        return {};
+    }
+
+    // Single items come first: they carry the highest supports and lift the
+    // threshold before any intersection is computed.
+    for(int position = 0; position < _items.size(); position++) {
+        offer(QVector<int>{position}, _tidLists[position].size());
+    }
+
+    for(int position = 0; position < _items.size(); position++) {
+        if(_tidLists[position].size() < threshold()) {
+            break;
+        }
+        searchFrequent(QVector<int>{position}, _tidLists[position], position);
+    }
+
+    return collect();
+}
+
+
+QMap<QVector<int>, int> TopKMiner::mineClosed(const int k)
+{
+    _k = k;
+    _bestSupports = {};
+    _found.clear();
+    if(_k <= 0 || _transactionsCount == 0) {
+        return {};
+    }
+
+    QVector<int> allTids(_transactionsCount);
+    for(int tid = 0; tid < _transactionsCount; tid++) {
+        allTids[tid] = tid;
+    }
+
+    // Items present in every transaction form the smallest closed itemset.
+    QVector<int> rootSet;
+    for(int position = 0; position < _items.size() && _tidLists[position].size() == _transactionsCount; position++) {
+        rootSet.append(position);
+    }
+    if(!rootSet.isEmpty()) {
+        offer(rootSet, _transactionsCount);
+    }
+
+    searchClosed(rootSet, allTids, -1);
+
+    return collect();
+}
+
+
+int TopKMiner::threshold()
+{
+    if(static_cast<int>(_bestSupports.size()) < _k) {
+        return 1;
+    }
+
+    return _bestSupports.top();
+}
+
+
+void TopKMiner::offer(const QVector<int> &positions, const int support)
+{
+    if(support < threshold()) {
+        return;
+    }
+
+    _bestSupports.push(support);
+    if(static_cast<int>(_bestSupports.size()) > _k) {
+        _bestSupports.pop();
+    }
+
+    QVector<int> itemset;
+    for(int position : positions) {
+        itemset.append(_items[position]);
+    }
+    std::sort(itemset.begin(), itemset.end());
+    _found[itemset] = support;
+
+    // Drop itemsets that fell below the raised threshold now and then.
+    if(_found.size() > 4 * std::max(_k, 1024)) {
+        int minCount = threshold();
+        for(auto it = _found.begin(); it != _found.end();) {
+            if(it.value() < minCount) {
+                it = _found.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+}
+
+
+void TopKMiner::searchFrequent(const QVector<int> &prefix, const QVector<int> &tidList, const int last)
+{
+    for(int position = last + 1; position < _items.size(); position++) {
+        // Items are in descending support order, so no later item can pass.
+        if(_tidLists[position].size() < threshold()) {
+            break;
+        }
+
+        QVector<int> extensionTids = intersect(tidList, _tidLists[position]);
+        if(extensionTids.size() < threshold()) {
+            continue;
+        }
+
+        QVector<int> extension = prefix;
+        extension.append(position);
+        offer(extension, extensionTids.size());
+        searchFrequent(extension, extensionTids, position);
+    }
+}
+
+
+void TopKMiner::searchClosed(const QVector<int> &closedSet, const QVector<int> &tidList, const int core)
+{
+    for(int position = core + 1; position < _items.size(); position++) {
+        if(_tidLists[position].size() < threshold()) {
+            break;
+        }
+        if(closedSet.contains(position)) {
+            continue;
+        }
+
+        QVector<int> extensionTids = intersect(tidList, _tidLists[position]);
+        if(extensionTids.size() < threshold()) {
+            continue;
+        }
+
+        QVector<int> extension = closure(closedSet, extensionTids, position);
+        if(extension.isEmpty()) {
+            continue;
+        }
+
+        offer(extension, extensionTids.size());
+        searchClosed(extension, extensionTids, position);
+    }
+}
+
+
+QVector<int> TopKMiner::closure(const QVector<int> &itemset, const QVector<int> &tidList, const int extension)
+{
+    QVector<int> closedSet = itemset;
+    closedSet.append(extension);
+
+    for(int position = 0; position < _items.size(); position++) {
+        if(_tidLists[position].size() < tidList.size()) {
+            break;
+        }
+        if(closedSet.contains(position)) {
+            continue;
+        }
+
+        if(std::includes(_tidLists[position].begin(), _tidLists[position].end(), tidList.begin(), tidList.end())) {
+            // Prefix-preserving check: an earlier item would make this closed
+            // set reachable from another branch as well.
+            if(position < extension) {
+                return {};
+            }
+            closedSet.append(position);
+        }
+    }
+
+    std::sort(closedSet.begin(), closedSet.end());
+
+    return closedSet;
+}
+
+
+QMap<QVector<int>, int> TopKMiner::collect()
+{
+    int minCount = threshold();
+
+    QMap<QVector<int>, int> itemsets;
+    for(auto it = _found.cbegin(); it != _found.cend(); it++) {
+        if(it.value() >= minCount) {
+            itemsets[it.key()] = it.value();
+        }
+    }
+
+    return itemsets;
+}
+
+
+QVector<int> TopKMiner::intersect(const QVector<int> &a, const QVector<int> &b)
+{
+    QVector<int> result;
+    result.reserve(std::min(a.size(), b.size()));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef TOPKMINER_H
+#define TOPKMINER_H
+
+#include <QVector>
+#include <QMap>
+#include <QHash>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <vector>
+
+
+// Top-k itemset mining without a minimum support (TKO / TFP style). The
+// search runs depth first over tid lists with items in descending support
+// order, so strong itemsets are found early; a min-heap of the k best
+// supports seen so far raises the internal threshold, and every branch whose
+// support falls below it is pruned.
+//
+// Ties are kept: the result holds every itemset whose support is at least
+// the k-th largest support, which getMinCount() returns afterwards. Closed
+// mode enumerates closed itemsets only, by prefix-preserving closure
+// extension (LCM).
+class TopKMiner
+{
+public:
+    // Constructors
+    TopKMiner(const QVector<QVector<int>> &transactions);
+
+    // Getters
+    int getMinCount();
+
+    // Functions
+    QMap<QVector<int>, int> mineFrequent(const int k);
+    QMap<QVector<int>, int> mineClosed(const int k);
+
+private:
+    // Fields
+    QVector<int> _items;
+    QVector<QVector<int>> _tidLists;
+    int _transactionsCount;
+    int _k;
+    std::priority_queue<int, std::vector<int>, std::greater<int>> _bestSupports;
+    QMap<QVector<int>, int> _found;
+
+    // Functions
+    int threshold();
+    void offer(const QVector<int> &positions, const int support);
+    void searchFrequent(const QVector<int> &prefix, const QVector<int> &tidList, const int last);
+    void searchClosed(const QVector<int> &closedSet, const QVector<int> &tidList, const int core);
+    QVector<int> closure(const QVector<int> &itemset, const QVector<int> &tidList, const int extension);
+    QMap<QVector<int>, int> collect();
+    static QVector<int> intersect(const QVector<int> &a, const QVector<int> &b);
+};
+
+
+#endif // TOPKMINER_H
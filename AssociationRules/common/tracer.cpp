@@ -0,0 +1,202 @@
+#include "tracer.h"
+
+
+// Events kept per thread; a power of two so the ring index is a mask.
+static const quint64 bufferCapacity = 1 << 16;
+
+
+struct TraceEvent
+{
+    const char *name;
+    const char *argumentName;
+    qint64 argumentValue;
+    qint64 timestamp;
+    char phase;
+};
+
+
+struct TraceBuffer
+{
+    std::vector<TraceEvent> events;
+    std::atomic<quint64> written;
+    std::atomic<bool> retired;
+    int threadId;
+};
+
+
+// Marks the thread's buffer when the thread exits. The buffer stays until the
+// next reset, so a run can still be written after its workers have joined.
+struct TraceRegistration
+{
+    TraceBuffer *buffer = nullptr;
+
+    ~TraceRegistration()
+    {
+        if(buffer) {
+            buffer->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+
+static std::atomic<bool> tracerEnabled(false);
+static std::mutex tracerMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> tracerBuffers;
+static int tracerThreadsCount = 0;
+static const std::chrono::steady_clock::time_point tracerEpoch = std::chrono::steady_clock::now();
+
+
+static TraceBuffer *threadBuffer()
+{
+    thread_local TraceRegistration registration;
+    if(!registration.buffer) {
+        std::unique_ptr<TraceBuffer> buffer(new TraceBuffer());
+        buffer->events.resize(bufferCapacity);
+        buffer->written.store(0, std::memory_order_relaxed);
+        buffer->retired.store(false, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(tracerMutex);
+        buffer->threadId = ++tracerThreadsCount;
+        registration.buffer = buffer.get();
+        tracerBuffers.push_back(std::move(buffer));
+    }
+
+    return registration.buffer;
+}
+
+
+static void record(const char phase, const char *name, const char *argumentName, const qint64 argumentValue)
+{
+    TraceBuffer *buffer = threadBuffer();
+    qint64 timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - tracerEpoch
+    ).count();
+
+    // Single writer per buffer: fill the slot, then publish it.
+    quint64 index = buffer->written.load(std::memory_order_relaxed);
+    buffer->events[index & (bufferCapacity - 1)] = {name, argumentName, argumentValue, timestamp, phase};
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+
+bool Tracer::isEnabled()
+{
+    return tracerEnabled.load(std::memory_order_relaxed);
+}
+
+
+void Tracer::setEnabled(const bool enabled)
+{
+    tracerEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+void Tracer::reset()
+{
+    // Only called between runs, while no other thread is recording.
+    std::lock_guard<std::mutex> lock(tracerMutex);
+    auto retired = [](const std::unique_ptr<TraceBuffer> &buffer) {
+        return buffer->retired.load(std::memory_order_acquire);
+    };
+    tracerBuffers.erase(std::remove_if(tracerBuffers.begin(), tracerBuffers.end(), retired), tracerBuffers.end());
+
+    for(std::unique_ptr<TraceBuffer> &buffer : tracerBuffers) {
+        buffer->written.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+void Tracer::begin(const char *name, const char *argumentName, const qint64 argumentValue)
+{
+    record('B', name, argumentName, argumentValue);
+}
+
+
+void Tracer::end(const char *name)
+{
+    record('E', name, nullptr, 0);
+}
+
+
+QByteArray Tracer::toJson()
+{
+    std::lock_guard<std::mutex> lock(tracerMutex);
+
+    auto jsonString = [](const char *text) {
+        QByteArray escaped = "\"";
+        for(const char *c = text; *c; c++) {
+            if(*c == '"' || *c == '\\') {
+                escaped += '\\';
+            }
+            escaped += *c;
+        }
+        return escaped + "\"";
+    };
+
+    QByteArray json = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    auto append = [&json, &first](const QByteArray &event) {
+        json += (first ? "\n  " : ",\n  ") + event;
+        first = false;
+    };
+
+    for(const std::unique_ptr<TraceBuffer> &buffer : tracerBuffers) {
+        QByteArray thread = ", \"pid\": 1, \"tid\": " + QByteArray::number(buffer->threadId);
+        append("{\"name\": \"thread_name\", \"ph\": \"M\"" + thread
+            + ", \"args\": {\"name\": \"thread " + QByteArray::number(buffer->threadId) + "\"}}");
+
+        quint64 written = buffer->written.load(std::memory_order_acquire);
+        quint64 oldest = written > bufferCapacity ? written - bufferCapacity : 0;
+        int depth = 0;
+        for(quint64 index = oldest; index < written; index++) {
+            const TraceEvent &event = buffer->events[index & (bufferCapacity - 1)];
+            if(event.phase == 'E' && depth == 0) {
+                continue;
+            }
+            depth += event.phase == 'B' ? 1 : -1;
+
+            QByteArray line = "{\"name\": " + jsonString(event.name) + ", \"cat\": \"arules\", \"ph\": \""
+                + event.phase + "\", \"ts\": " + QByteArray::number(event.timestamp / 1000.0, 'f', 3) + thread;
+            if(event.argumentName) {
+                line += ", \"args\": {" + jsonString(event.argumentName) + ": "
+                    + QByteArray::number(event.argumentValue) + "}";
+            }
+            append(line + "}");
+        }
+    }
+    json += "\n]}\n";
+
+    return json;
+}
+
+
+bool Tracer::writeJson(const QString &filePath, QString &errorString)
+{
+    QByteArray json = toJson();
+
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+        errorString = "Unable to write the trace file " + filePath;
+        return false;
+    }
+
+    return true;
+}
+
+
+TraceScope::TraceScope(const char *name, const char *argumentName, const qint64 argumentValue)
+{
+    _name = name;
+    _active = Tracer::isEnabled();
+    if(_active) {
+        Tracer::begin(name, argumentName, argumentValue);
+    }
+}
+
+
+TraceScope::~TraceScope()
+{
+    if(_active) {
+        Tracer::end(_name);
+    }
+}
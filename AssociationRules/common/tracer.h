@@ -0,0 +1,74 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+
+// Begin/end events of the instrumented phases, written out in the Chrome
+// trace event format that Perfetto and chrome://tracing open. Every thread
+// records into a ring buffer of its own, registered the first time it traces;
+// after that a record is two stores and no lock. When a buffer wraps the
+// oldest events are overwritten, and toJson() drops end events whose begin
+// was lost.
+//
+// Events are recorded through PROFILE_SCOPE, which also times the phase, and
+// TRACE_SCOPE / TRACE_SCOPE_VALUE for finer spans (a level, a task) that
+// should show up in the trace but not in the profiler's phase totals.
+class Tracer
+{
+public:
+    // Getters
+    static bool isEnabled();
+
+    // Setters
+    static void setEnabled(const bool enabled);
+
+    // Functions
+    static void reset();
+    static void begin(const char *name, const char *argumentName = nullptr, const qint64 argumentValue = 0);
+    static void end(const char *name);
+    static QByteArray toJson();
+    static bool writeJson(const QString &filePath, QString &errorString);
+};
+
+
+// Records a begin event on construction and the matching end on destruction.
+class TraceScope
+{
+public:
+    // Constructors
+    TraceScope(const char *name, const char *argumentName = nullptr, const qint64 argumentValue = 0);
+    ~TraceScope();
+
+private:
+    // Fields
+    const char *_name;
+    bool _active;
+};
+
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ARULES_PROFILING
+#define TRACE_SCOPE(name) TraceScope PROFILE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_SCOPE_VALUE(name, argumentName, argumentValue) \
+    TraceScope PROFILE_CONCAT(traceScope, __LINE__)(name, argumentName, argumentValue)
+#else
+#define TRACE_SCOPE(name) do {} while(0)
+#define TRACE_SCOPE_VALUE(name, argumentName, argumentValue) do {} while(0)
+#endif
+
+
+#endif // TRACER_H
@@ -0,0 +1,319 @@
+#include "transactioncache.h"
+
+
+static const char cacheMagic[4] = {'A', 'R', 'T', 'C'};
+static const quint32 cacheVersion = 2;
+static const quint32 rowIndexFlag = 0x1;
+static const qint64 headerSize = 64;
+
+static std::atomic<bool> cacheWriteEnabled(true);
+
+
+static quint64 alignedSize(quint64 size)
+{
+    return (size + 7) & ~quint64(7);
+}
+
+
+TransactionCache::TransactionCache(const QString &sourceFilePath)
+{
+    _sourceFilePath = sourceFilePath;
+    _cacheFilePath = sourceFilePath + ".arc";
+}
+
+
+QString TransactionCache::getCacheFilePath()
+{
+    return _cacheFilePath;
+}
+
+
+QMap<int, int> TransactionCache::getItemFrequencies()
+{
+    return _itemFrequencies;
+}
+
+
+void TransactionCache::setWriteEnabled(const bool enabled)
+{
+    cacheWriteEnabled = enabled;
+}
+
+
+bool TransactionCache::load(QVector<QVector<int>> &transactions)
+{
+    QFileInfo sourceInfo(_sourceFilePath);
+    QFileInfo cacheInfo(_cacheFilePath);
+    if(!sourceInfo.exists() || !cacheInfo.exists() || cacheInfo.size() < headerSize) {
+        return false;
+    }
+
+    QFile file(_cacheFilePath);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 fileSize = file.size();
+    uchar *data = file.map(0, fileSize);
+    if(!data) {
+        return false;
+    }
+
+    bool success = false;
+    quint64 sourceSize = qFromLittleEndian<quint64>(data + 16);
+    qint64 sourceMtime = qFromLittleEndian<qint64>(data + 24);
+    quint64 payloadSize = qFromLittleEndian<quint64>(data + 48);
+    quint64 storedChecksum = qFromLittleEndian<quint64>(data + 56);
+
+    if(memcmp(data, cacheMagic, sizeof(cacheMagic)) == 0 &&
+        qFromLittleEndian<quint32>(data + 4) == cacheVersion &&
+        sourceSize == static_cast<quint64>(sourceInfo.size()) &&
+        sourceMtime == sourceInfo.lastModified().toMSecsSinceEpoch() &&
+        payloadSize == static_cast<quint64>(fileSize - headerSize) &&
+        checksum(data + headerSize, payloadSize) == storedChecksum
+    ) {
+        success = decode(data, fileSize, transactions);
+    }
+
+    file.unmap(data);
+    file.close();
+
+    if(!success) {
+        qWarning() << "Ignoring stale or corrupt transaction cache:" << _cacheFilePath;
+        transactions.clear();
+        _itemFrequencies.clear();
+    }
+
+    return success;
+}
+
+
+bool TransactionCache::decode(const uchar *data, qint64 size, QVector<QVector<int>> &transactions)
+{
+    quint32 flags = qFromLittleEndian<quint32>(data + 8);
+    quint64 itemCount = qFromLittleEndian<quint32>(data + 12);
+    quint64 rowCount = qFromLittleEndian<quint64>(data + 32);
+    quint64 transactionCount = qFromLittleEndian<quint64>(data + 40);
+    bool hasRowIndex = flags & rowIndexFlag;
+
+    // Sections are validated against the mapped size before anything is read.
+    quint64 itemsOffset = headerSize;
+    quint64 frequenciesOffset = itemsOffset + alignedSize(itemCount * 4);
+    quint64 offsetsOffset = frequenciesOffset + alignedSize(itemCount * 4);
+    if(rowCount > static_cast<quint64>(size) / 8 || transactionCount > static_cast<quint64>(size) / 4) {
+        return false;
+    }
+    quint64 rowIndexOffset = offsetsOffset + (rowCount + 1) * 8;
+    quint64 dataOffset = rowIndexOffset + (hasRowIndex ? alignedSize(transactionCount * 4) : 0);
+    if(dataOffset > static_cast<quint64>(size)) {
+        return false;
+    }
+
+    const uchar *offsets = data + offsetsOffset;
+    quint64 dataSize = qFromLittleEndian<quint64>(offsets + rowCount * 8);
+    if(dataOffset + dataSize != static_cast<quint64>(size)) {
+        return false;
+    }
+
+    QVector<int> items(itemCount);
+    for(quint64 i = 0; i < itemCount; i++) {
+        items[i] = qFromLittleEndian<qint32>(data + itemsOffset + i * 4);
+        _itemFrequencies[items[i]] = qFromLittleEndian<quint32>(data + frequenciesOffset + i * 4);
+    }
+
+    QVector<QVector<int>> rows;
+    rows.reserve(rowCount);
+    for(quint64 row = 0; row < rowCount; row++) {
+        quint64 begin = qFromLittleEndian<quint64>(offsets + row * 8);
+        quint64 end = qFromLittleEndian<quint64>(offsets + (row + 1) * 8);
+        if(begin > end || end > dataSize) {
+            return false;
+        }
+
+        const uchar *cursor = data + dataOffset + begin;
+        const uchar *rowEnd = data + dataOffset + end;
+        QVector<int> transaction;
+        quint32 index = 0;
+        while(cursor < rowEnd) {
+            quint32 delta;
+            if(!readVarint(cursor, rowEnd, delta)) {
+                return false;
+            }
+
+            index += delta;
+            if(index >= itemCount) {
+                return false;
+            }
+            transaction.append(items[index]);
+        }
+
+        rows.append(transaction);
+    }
+
+    if(!hasRowIndex) {
+        transactions = rows;
+
+        return rowCount == transactionCount;
+    }
+
+    // Duplicate transactions share one implicitly shared vector.
+    transactions.clear();
+    transactions.reserve(transactionCount);
+    for(quint64 t = 0; t < transactionCount; t++) {
+        quint32 row = qFromLittleEndian<quint32>(data + rowIndexOffset + t * 4);
+        if(row >= rowCount) {
+            return false;
+        }
+        transactions.append(rows[row]);
+    }
+
+    return true;
+}
+
+
+bool TransactionCache::save(const QVector<QVector<int>> &transactions)
+{
+    QFileInfo sourceInfo(_sourceFilePath);
+    if(!cacheWriteEnabled || !sourceInfo.exists()) {
+        return false;
+    }
+
+    _itemFrequencies.clear();
+    // Duplicate rows are stored once; the row index keeps the file order, so a
+    // reload gives the same transactions in the same order as the text parse.
+    QHash<QVector<int>, int> rowIndex;
+    QVector<QVector<int>> rows;
+    QVector<quint32> transactionRows;
+    transactionRows.reserve(transactions.size());
+    for(const QVector<int> &transaction : transactions) {
+        for(int item : transaction) {
+            _itemFrequencies[item]++;
+        }
+
+        auto found = rowIndex.find(transaction);
+        if(found != rowIndex.end()) {
+            transactionRows.append(found.value());
+        } else {
+            rowIndex.insert(transaction, rows.size());
+            transactionRows.append(rows.size());
+            rows.append(transaction);
+        }
+    }
+    bool hasRowIndex = rows.size() < transactions.size();
+
+    QVector<int> items = _itemFrequencies.keys();
+    quint64 itemCount = items.size();
+    quint64 rowCount = rows.size();
+
+    QByteArray encoded;
+    QVector<quint64> offsets;
+    offsets.reserve(rowCount + 1);
+    for(const QVector<int> &row : rows) {
+        offsets.append(encoded.size());
+        int previous = 0;
+        for(int item : row) {
+            int index = std::lower_bound(items.begin(), items.end(), item) - items.begin();
+            appendVarint(encoded, index - previous);
+            previous = index;
+        }
+    }
+    offsets.append(encoded.size());
+
+    QByteArray payload;
+    payload.reserve(alignedSize(itemCount * 4) * 2 + (rowCount + 1) * 8 + (hasRowIndex ? alignedSize(transactions.size() * 4) : 0) + encoded.size());
+    auto appendPadding = [&payload]() {
+        payload.append(QByteArray(alignedSize(payload.size()) - payload.size(), '\0'));
+    };
+
+    for(int item : items) {
+        qint32 value = qToLittleEndian<qint32>(item);
+        payload.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    appendPadding();
+    for(int item : items) {
+        quint32 value = qToLittleEndian<quint32>(_itemFrequencies[item]);
+        payload.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    appendPadding();
+    for(quint64 offset : offsets) {
+        quint64 value = qToLittleEndian<quint64>(offset);
+        payload.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    if(hasRowIndex) {
+        for(quint32 row : transactionRows) {
+            quint32 value = qToLittleEndian<quint32>(row);
+            payload.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        appendPadding();
+    }
+    payload.append(encoded);
+
+    uchar header[headerSize] = {};
+    memcpy(header, cacheMagic, sizeof(cacheMagic));
+    qToLittleEndian<quint32>(cacheVersion, header + 4);
+    qToLittleEndian<quint32>(hasRowIndex ? rowIndexFlag : 0, header + 8);
+    qToLittleEndian<quint32>(itemCount, header + 12);
+    qToLittleEndian<quint64>(sourceInfo.size(), header + 16);
+    qToLittleEndian<qint64>(sourceInfo.lastModified().toMSecsSinceEpoch(), header + 24);
+    qToLittleEndian<quint64>(rowCount, header + 32);
+    qToLittleEndian<quint64>(transactions.size(), header + 40);
+    qToLittleEndian<quint64>(payload.size(), header + 48);
+    qToLittleEndian<quint64>(checksum(reinterpret_cast<const uchar*>(payload.constData()), payload.size()), header + 56);
+
+    QSaveFile file(_cacheFilePath);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write transaction cache:" << _cacheFilePath;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(header), headerSize);
+    file.write(payload);
+
+    return file.commit();
+}
+
+
+quint64 TransactionCache::checksum(const uchar *data, qint64 size)
+{
+    // FNV-1a over 64-bit words, folding the high half back in after every step.
+    quint64 hash = 14695981039346656037ULL;
+    qint64 i = 0;
+    for(; i + 8 <= size; i += 8) {
+        hash ^= qFromLittleEndian<quint64>(data + i);
+        hash *= 1099511628211ULL;
+        hash ^= hash >> 32;
+    }
+
+    for(; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
+void TransactionCache::appendVarint(QByteArray &buffer, quint32 value)
+{
+    while(value >= 0x80) {
+        buffer.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+
+    buffer.append(static_cast<char>(value));
+}
+
+
+bool TransactionCache::readVarint(const uchar *&cursor, const uchar *end, quint32 &value)
+{
+    value = 0;
+    for(int shift = 0; shift < 35 && cursor < end; shift += 7) {
+        uchar byte = *cursor++;
+        value |= static_cast<quint32>(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,64 @@
+#ifndef TRANSACTIONCACHE_H
+#define TRANSACTIONCACHE_H
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QtEndian>
+#include <QDebug>
+
+#include <atomic>
+
+
+// Binary sidecar ("<input>.arc") holding an already parsed transaction file.
+//
+// Layout (little-endian, every section 8-byte aligned):
+//   header       magic, version, flags, source size and mtime, counts, checksum
+//   items        itemCount x int32, sorted item dictionary
+//   frequencies  itemCount x uint32, occurrences of the item
+//   offsets      (rowCount + 1) x uint64, CSR byte offsets into the data section
+//   rows         transactionCount x uint32, row of every transaction in file
+//                order, only when duplicate rows were collapsed
+//   data         per distinct row, varint delta-encoded dictionary indices
+//
+// The sidecar is only trusted when the source file still has the size and
+// modification time recorded in the header and the payload checksum matches.
+// Writing can be switched off process-wide, so a benchmark can time the text
+// parse alone.
+class TransactionCache
+{
+public:
+    // Constructors
+    TransactionCache(const QString &sourceFilePath);
+
+    // Getters
+    QString getCacheFilePath();
+    QMap<int, int> getItemFrequencies();
+
+    // Setters
+    static void setWriteEnabled(const bool enabled);
+
+    // Functions
+    bool load(QVector<QVector<int>> &transactions);
+    bool save(const QVector<QVector<int>> &transactions);
+
+private:
+    // Fields
+    QString _sourceFilePath;
+    QString _cacheFilePath;
+    QMap<int, int> _itemFrequencies;
+
+    // Functions
+    bool decode(const uchar *data, qint64 size, QVector<QVector<int>> &transactions);
+    static quint64 checksum(const uchar *data, qint64 size);
+    static void appendVarint(QByteArray &buffer, quint32 value);
+    static bool readVarint(const uchar *&cursor, const uchar *end, quint32 &value);
+};
+
+
+#endif // TRANSACTIONCACHE_H
@@ -0,0 +1,226 @@
+#include "transactionreader.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+
+static const qint64 readBlockSize = 1 << 20;
+static const int followPollInterval = 200;
+
+
+TransactionReader::TransactionReader(const QString &filePath)
+{
+    _filePath = filePath;
+    _bufferBegin = 0;
+    _bufferEnd = 0;
+    _bufferOffset = 0;
+    _rangeBegin = 0;
+    _rangeEnd = -1;
+    _bytesRead = 0;
+    _endOfFile = false;
+    _follow = false;
+}
+
+
+QString TransactionReader::getErrorString()
+{
+    return _errorString;
+}
+
+
+qint64 TransactionReader::getBytesRead()
+{
+    return _bytesRead;
+}
+
+
+void TransactionReader::setRange(const qint64 begin, const qint64 end)
+{
+    _rangeBegin = begin;
+    _rangeEnd = end;
+}
+
+
+void TransactionReader::setFollow(const bool follow)
+{
+    _follow = follow;
+}
+
+
+bool TransactionReader::open()
+{
+    // Unbuffered reads see lines appended after an earlier end of file.
+    QIODevice::OpenMode mode = QIODevice::ReadOnly;
+    if(_follow) {
+        mode |= QIODevice::Unbuffered;
+    }
+
+    bool opened;
+    if(_filePath == "-") {
+        opened = _file.open(stdin, mode);
+    } else {
+        _file.setFileName(_filePath);
+        opened = _file.open(mode);
+    }
+
+    if(!opened) {
+        _errorString = "Unable to open the input file";
+        return false;
+    }
+
+    return rewind();
+}
+
+
+bool TransactionReader::rewind()
+{
+    // Starting one byte early tells whether the range begins on a line start;
+    // if not, the partial line belongs to the previous range.
+    qint64 start = std::max<qint64>(0, _rangeBegin - 1);
+    bool seekable = !_file.isSequential() || (start == 0 && _bytesRead == 0);
+    if(!seekable || (!_file.isSequential() && !_file.seek(start))) {
+        _errorString = "Unable to rewind the input file";
+        return false;
+    }
+
+    _buffer.resize(readBlockSize);
+    _bufferBegin = 0;
+    _bufferEnd = 0;
+    _bufferOffset = start;
+    _bytesRead = 0;
+    _endOfFile = false;
+    _errorString.clear();
+
+    if(_rangeBegin > 0) {
+        while(true) {
+            const char *begin = _buffer.constData() + _bufferBegin;
+            const char *newline = static_cast<const char*>(memchr(begin, '\n', _bufferEnd - _bufferBegin));
+            if(newline) {
+                _bufferBegin = newline - _buffer.constData() + 1;
+                break;
+            }
+
+            _bufferBegin = _bufferEnd;
+            if(_endOfFile || !fillBuffer()) {
+                break;
+            }
+        }
+    }
+
+    return !hasError();
+}
+
+
+bool TransactionReader::hasError()
+{
+    return !_errorString.isEmpty();
+}
+
+
+bool TransactionReader::next(QVector<int> &transaction)
+{
+    while(true) {
+        const char *data = _buffer.constData();
+        const char *begin = data + _bufferBegin;
+        const char *end = data + _bufferEnd;
+        const char *newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+
+        if(_rangeEnd >= 0 && _bufferOffset + _bufferBegin >= _rangeEnd) {
+            return false;
+        }
+
+        if(newline || (_endOfFile && begin != end)) {
+            const char *lineEnd = newline ? newline : end;
+            _bufferBegin = (lineEnd - data) + (newline ? 1 : 0);
+            return parseLine(begin, lineEnd, transaction);
+        }
+
+        if(_endOfFile || !fillBuffer()) {
+            return false;
+        }
+    }
+}
+
+
+bool TransactionReader::fillBuffer()
+{
+    qint64 pending = _bufferEnd - _bufferBegin;
+    if(_bufferBegin > 0) {
+        memmove(_buffer.data(), _buffer.constData() + _bufferBegin, pending);
+    }
+    if(pending == _buffer.size()) {
+        _buffer.resize(_buffer.size() * 2);
+    }
+
+    _bufferOffset += _bufferBegin;
+    _bufferBegin = 0;
+    _bufferEnd = pending;
+
+    qint64 received = _file.read(_buffer.data() + _bufferEnd, _buffer.size() - _bufferEnd);
+    if(received < 0) {
+        _errorString = "Unable to read from the input file";
+        return false;
+    }
+    if(received == 0) {
+        if(_follow) {
+            QThread::msleep(followPollInterval);
+        } else {
+            _endOfFile = true;
+        }
+    }
+
+    _bufferEnd += received;
+    _bytesRead += received;
+    PROFILE_COUNT("bytes parsed", received);
+
+    return true;
+}
+
+
+bool TransactionReader::parseLine(const char *begin, const char *end, QVector<int> &transaction)
+{
+    transaction.clear();
+
+    const char *cursor = begin;
+    while(cursor < end) {
+        while(cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) {
+            cursor++;
+        }
+        if(cursor == end) {
+            break;
+        }
+
+        bool negative = *cursor == '-';
+        if(negative || *cursor == '+') {
+            cursor++;
+        }
+
+        qint64 value = 0;
+        const char *digits = cursor;
+        while(cursor < end && *cursor >= '0' && *cursor <= '9') {
+            value = value * 10 + (*cursor - '0');
+            if(value > static_cast<qint64>(INT_MAX) + 1) {
+                break;
+            }
+            cursor++;
+        }
+
+        bool separated = cursor == end || *cursor == ' ' || *cursor == '\t' || *cursor == '\r';
+        if(cursor == digits || !separated || value > static_cast<qint64>(INT_MAX) + (negative ? 1 : 0)) {
+            _errorString = "Invalid input file: Non-numeric value";
+            return false;
+        }
+
+        transaction.append(static_cast<int>(negative ? -value : value));
+    }
+
+    if(transaction.isEmpty()) {
+        _errorString = "Invalid input file: Empty line";
+        return false;
+    }
+
+    std::sort(transaction.begin(), transaction.end());
+
+    return true;
+}
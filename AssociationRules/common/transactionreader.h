@@ -0,0 +1,64 @@
+#ifndef TRANSACTIONREADER_H
+#define TRANSACTIONREADER_H
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <QFile>
+#include <QThread>
+
+#include "profiler.h"
+
+
+// Streams a whitespace separated transaction file one transaction at a time,
+// so callers never need more than the current line in memory. Lines are
+// validated with the same rules as the tabs' readFile functions.
+//
+// A byte range restricts the reader to the lines starting inside it, which
+// lets several readers split one file without coordinating on line ends.
+//
+// The path "-" reads standard input. In follow mode the end of the file is
+// treated as "no data yet": the reader waits for more lines to be appended
+// instead of finishing, and never parses a line before its newline arrives.
+class TransactionReader
+{
+public:
+    // Constructors
+    TransactionReader(const QString &filePath);
+
+    // Getters
+    QString getErrorString();
+    qint64 getBytesRead();
+
+    // Setters
+    void setRange(const qint64 begin, const qint64 end);
+    void setFollow(const bool follow);
+
+    // Functions
+    bool open();
+    bool rewind();
+    bool next(QVector<int> &transaction);
+    bool hasError();
+
+private:
+    // Fields
+    QString _filePath;
+    QString _errorString;
+    QFile _file;
+    QByteArray _buffer;
+    qint64 _bufferBegin;
+    qint64 _bufferEnd;
+    qint64 _bufferOffset;
+    qint64 _rangeBegin;
+    qint64 _rangeEnd;
+    qint64 _bytesRead;
+    bool _endOfFile;
+    bool _follow;
+
+    // Functions
+    bool fillBuffer();
+    bool parseLine(const char *begin, const char *end, QVector<int> &transaction);
+};
+
+
+#endif // TRANSACTIONREADER_H
@@ -0,0 +1,154 @@
+#include "vectorreader.h"
+
+#include <charconv>
+#include <cstring>
+
+
+static inline bool isBlank(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+
+VectorReader::VectorReader(const QString &filePath)
+{
+    _filePath = filePath;
+    _map = nullptr;
+    _begin = nullptr;
+    _cursor = nullptr;
+    _end = nullptr;
+    _lineNumber = 0;
+}
+
+
+VectorReader::~VectorReader()
+{
+    if(_map) {
+        _file.unmap(_map);
+    }
+}
+
+
+QString VectorReader::getErrorString()
+{
+    return _errorString;
+}
+
+
+qint64 VectorReader::getBytesRead()
+{
+    return _cursor - _begin;
+}
+
+
+int VectorReader::getLineNumber()
+{
+    return _lineNumber;
+}
+
+
+bool VectorReader::open()
+{
+    _file.setFileName(_filePath);
+    if(!_file.open(QIODevice::ReadOnly)) {
+        _errorString = "Unable to open " + _filePath;
+        return false;
+    }
+
+    qint64 size = _file.size();
+    if(size > 0 && !_file.isSequential()) {
+        _map = _file.map(0, size);
+    }
+
+    if(_map) {
+        _begin = reinterpret_cast<const char*>(_map);
+        _end = _begin + size;
+    } else {
+        _buffer = _file.readAll();
+        _begin = _buffer.constData();
+        _end = _begin + _buffer.size();
+    }
+    _cursor = _begin;
+    _lineNumber = 0;
+    _errorString.clear();
+    PROFILE_COUNT("bytes parsed", _end - _begin);
+
+    return true;
+}
+
+
+bool VectorReader::next(QVector<double> &vector)
+{
+    while(_cursor < _end && !hasError()) {
+        const char *newline = static_cast<const char*>(memchr(_cursor, '\n', _end - _cursor));
+        const char *lineBegin = _cursor;
+        const char *lineEnd = newline ? newline : _end;
+        _cursor = newline ? newline + 1 : _end;
+        _lineNumber++;
+
+        const char *first = lineBegin;
+        while(first < lineEnd && isBlank(*first)) {
+            first++;
+        }
+        if(first == lineEnd) {
+            continue;
+        }
+
+        return parseLine(lineBegin, lineEnd, vector);
+    }
+
+    return false;
+}
+
+
+bool VectorReader::hasError()
+{
+    return !_errorString.isEmpty();
+}
+
+
+bool VectorReader::parseLine(const char *begin, const char *end, QVector<double> &vector)
+{
+    // Keeps the capacity of the previous row.
+    vector.resize(0);
+
+    const char *cursor = begin;
+    while(true) {
+        while(cursor < end && isBlank(*cursor)) {
+            cursor++;
+        }
+
+        // from_chars does not take a leading plus sign, QString::toDouble does.
+        const char *token = cursor;
+        if(cursor + 1 < end && *cursor == '+' && cursor[1] != '-') {
+            cursor++;
+        }
+
+        double value;
+        std::from_chars_result result = std::from_chars(cursor, end, value);
+        cursor = result.ptr;
+        while(cursor < end && isBlank(*cursor)) {
+            cursor++;
+        }
+
+        if(result.ec != std::errc() || (cursor < end && *cursor != ',')) {
+            const char *tokenEnd = static_cast<const char*>(memchr(token, ',', end - token));
+            tokenEnd = tokenEnd ? tokenEnd : end;
+            while(tokenEnd > token && isBlank(tokenEnd[-1])) {
+                tokenEnd--;
+            }
+
+            _errorString = QString("Line %1, column %2: \"%3\" is not a number")
+                               .arg(_lineNumber)
+                               .arg(token - begin + 1)
+                               .arg(QString::fromUtf8(token, tokenEnd - token));
+            return false;
+        }
+
+        vector.append(value);
+        if(cursor == end) {
+            return true;
+        }
+        cursor++;
+    }
+}
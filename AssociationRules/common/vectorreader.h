@@ -0,0 +1,54 @@
+#ifndef VECTORREADER_H
+#define VECTORREADER_H
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <QFile>
+
+#include "profiler.h"
+
+
+// Streams a comma separated vector file one row at a time. The file is
+// mapped into memory and every value is parsed in place with
+// std::from_chars, which rounds correctly and allocates nothing; the caller's
+// vector is reused from row to row, so a file is read without a per-value
+// allocation. Files that cannot be mapped, such as pipes, are read whole.
+//
+// Blank lines are skipped. The first token that is not a number stops the
+// reader, and the error names its line and column.
+class VectorReader
+{
+public:
+    // Constructors
+    VectorReader(const QString &filePath);
+    ~VectorReader();
+
+    // Getters
+    QString getErrorString();
+    qint64 getBytesRead();
+    int getLineNumber();
+
+    // Functions
+    bool open();
+    bool next(QVector<double> &vector);
+    bool hasError();
+
+private:
+    // Fields
+    QString _filePath;
+    QString _errorString;
+    QFile _file;
+    QByteArray _buffer;
+    uchar *_map;
+    const char *_begin;
+    const char *_cursor;
+    const char *_end;
+    int _lineNumber;
+
+    // Functions
+    bool parseLine(const char *begin, const char *end, QVector<double> &vector);
+};
+
+
+#endif // VECTORREADER_H
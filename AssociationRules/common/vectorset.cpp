@@ -0,0 +1,97 @@
+#include "vectorset.h"
+
+
+// Doubles per padded row block: one AVX-512 register.
+static const int strideAlignment = 8;
+
+
+VectorSet::VectorSet()
+{
+    _rowsCount = 0;
+    _dimension = 0;
+    _stride = 0;
+}
+
+
+int VectorSet::getRowsCount() const
+{
+    return _rowsCount;
+}
+
+
+int VectorSet::getDimension() const
+{
+    return _dimension;
+}
+
+
+int VectorSet::getStride() const
+{
+    return _stride;
+}
+
+
+const double *VectorSet::getRow(const int row) const
+{
+    return _values.data() + static_cast<size_t>(row) * _stride;
+}
+
+
+QString VectorSet::getErrorString() const
+{
+    return _errorString;
+}
+
+
+bool VectorSet::load(const QString &filePath)
+{
+    _rowsCount = 0;
+    _dimension = 0;
+    _stride = 0;
+    _values.clear();
+    _errorString.clear();
+
+    VectorReader reader(filePath);
+    if(!reader.open()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    QVector<double> vector;
+    while(reader.next(vector)) {
+        if(!append(vector)) {
+            _errorString = QString("Line %1: %2 values, expected %3").arg(reader.getLineNumber()).arg(vector.size()).arg(_dimension);
+            return false;
+        }
+    }
+
+    if(reader.hasError()) {
+        _errorString = reader.getErrorString();
+        return false;
+    }
+
+    if(_rowsCount == 0) {
+        _errorString = filePath + " holds no vectors";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool VectorSet::append(const QVector<double> &vector)
+{
+    if(_rowsCount == 0) {
+        _dimension = vector.size();
+        _stride = (_dimension + strideAlignment - 1) / strideAlignment * strideAlignment;
+    } else if(vector.size() != _dimension) {
+        return false;
+    }
+
+    _values.resize(_values.size() + _stride, 0.0);
+    std::copy(vector.begin(), vector.end(), _values.end() - _stride);
+    _rowsCount++;
+
+    return true;
+}
+
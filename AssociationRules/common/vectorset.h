@@ -0,0 +1,47 @@
+#ifndef VECTORSET_H
+#define VECTORSET_H
+
+#include <QString>
+#include <QVector>
+
+#include <algorithm>
+#include <vector>
+
+#include "vectorreader.h"
+
+
+// A set of equally long vectors stored row by row in one contiguous block.
+// Rows are padded with zeros to a multiple of eight values, so the distance
+// kernels can read whole SIMD registers without handling a tail; the padding
+// does not change any of the supported distances.
+//
+// load() reads one vector per line, values separated by commas, which is the
+// Distance tab's single vector format repeated over lines.
+class VectorSet
+{
+public:
+    // Constructors
+    VectorSet();
+
+    // Getters
+    int getRowsCount() const;
+    int getDimension() const;
+    int getStride() const;
+    const double *getRow(const int row) const;
+    QString getErrorString() const;
+
+    // Functions
+    bool load(const QString &filePath);
+    bool append(const QVector<double> &vector);
+
+private:
+    // Fields
+    int _rowsCount;
+    int _dimension;
+    int _stride;
+    std::vector<double> _values;
+    QString _errorString;
+};
+
+
+#endif // VECTORSET_H
@@ -0,0 +1,254 @@
+#include "vptree.h"
+
+
+// Subtrees with at most this many points are scanned instead of split.
+static const int leafSize = 8;
+
+
+VpTree::VpTree(const double p, const bool cosine, const int threadsCount)
+{
+    _p = cosine ? 2 : p;
+    _cosine = cosine;
+    _threadsCount = threadsCount > 0 ? threadsCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    _distancesCount = 0;
+}
+
+
+qint64 VpTree::getDistancesCount()
+{
+    return _distancesCount;
+}
+
+
+void VpTree::build(const VectorSet &points)
+{
+    _points = VectorSet();
+    _order.clear();
+    _nodes.clear();
+
+    int dimension = points.getDimension();
+    QVector<double> vector(dimension);
+    for(int row = 0; row < points.getRowsCount(); row++) {
+        std::copy(points.getRow(row), points.getRow(row) + dimension, vector.begin());
+        if(_cosine) {
+            normalize(points.getRow(row), dimension, vector.data());
+        }
+        _points.append(vector);
+
+        bool zero = _cosine && std::all_of(vector.begin(), vector.end(), [](const double value) { return value == 0; });
+        if(!zero) {
+            _order.push_back(row);
+        }
+    }
+
+    std::mt19937 generator(0);
+    std::vector<double> distances(points.getRowsCount());
+    if(!_order.empty()) {
+        buildNode(0, static_cast<int>(_order.size()), generator, distances);
+    }
+}
+
+
+QVector<VpTree::Neighbour> VpTree::search(const double *query, const int k, const double radius, const int excluded)
+{
+    Search search;
+    search.query = query;
+    search.k = k;
+    search.radius = radius;
+    search.excluded = excluded;
+    search.distancesCount = 0;
+
+    int dimension = _points.getDimension();
+    if(_cosine) {
+        search.normalized.assign(_points.getStride(), 0.0);
+        normalize(query, dimension, search.normalized.data());
+        search.query = search.normalized.data();
+        if(std::all_of(search.normalized.begin(), search.normalized.end(), [](const double value) { return value == 0; })) {
+            return {};
+        }
+    }
+
+    if(!_nodes.empty()) {
+        searchNode(0, search);
+    }
+    _distancesCount += search.distancesCount;
+
+    QVector<Neighbour> neighbours(static_cast<int>(search.best.size()));
+    for(int i = neighbours.size() - 1; i >= 0; i--) {
+        neighbours[i] = {search.best.top().second, search.best.top().first};
+        search.best.pop();
+    }
+
+    return neighbours;
+}
+
+
+QVector<QVector<VpTree::Neighbour>> VpTree::searchAll(const VectorSet &queries, const int k, const double radius, const bool excludeSelf)
+{
+    _distancesCount = 0;
+
+    int queriesCount = queries.getRowsCount();
+    QVector<QVector<Neighbour>> results(queriesCount);
+    std::atomic<int> next(0);
+    auto work = [&]() {
+        for(int query = next++; query < queriesCount; query = next++) {
+            results[query] = search(queries.getRow(query), k, radius, excludeSelf ? query : -1);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(int thread = 1; thread < std::min(_threadsCount, queriesCount); thread++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for(std::thread &thread : threads) {
+        thread.join();
+    }
+
+    return results;
+}
+
+
+double VpTree::cosineSimilarity(const double distance)
+{
+    return std::clamp(1 - distance * distance / 2, -1.0, 1.0);
+}
+
+
+double VpTree::cosineRadius(const double minSimilarity)
+{
+    return std::sqrt(std::max(0.0, 2 - 2 * minSimilarity));
+}
+
+
+int VpTree::buildNode(const int begin, const int end, std::mt19937 &generator, std::vector<double> &distances)
+{
+    int node = static_cast<int>(_nodes.size());
+    _nodes.push_back({-1, 0, -1, -1, begin, end});
+    if(end - begin <= leafSize) {
+        return node;
+    }
+
+    // The vantage point moves to the front, the rest is split at the median.
+    std::uniform_int_distribution<int> distribution(begin, end - 1);
+    std::swap(_order[begin], _order[distribution(generator)]);
+    int vantagePoint = _order[begin];
+    for(int i = begin + 1; i < end; i++) {
+        distances[_order[i]] = distance(_points.getRow(vantagePoint), _points.getRow(_order[i]));
+    }
+
+    int middle = (begin + 1 + end) / 2;
+    std::nth_element(_order.begin() + begin + 1, _order.begin() + middle, _order.begin() + end,
+        [&distances](const int a, const int b) {
+            return distances[a] < distances[b];
+        }
+    );
+
+    _nodes[node].point = vantagePoint;
+    _nodes[node].threshold = distances[_order[middle]];
+    int inside = buildNode(begin + 1, middle, generator, distances);
+    int outside = buildNode(middle, end, generator, distances);
+    _nodes[node].inside = inside;
+    _nodes[node].outside = outside;
+
+    return node;
+}
+
+
+void VpTree::searchNode(const int node, Search &search)
+{
+    const Node &current = _nodes[node];
+    if(current.point < 0) {
+        for(int i = current.begin; i < current.end; i++) {
+            offer(_order[i], distance(search.query, _points.getRow(_order[i])), search);
+            search.distancesCount++;
+        }
+        return;
+    }
+
+    double vantageDistance = distance(search.query, _points.getRow(current.point));
+    search.distancesCount++;
+    offer(current.point, vantageDistance, search);
+
+    // Inside points lie within threshold of the vantage point, outside ones
+    // at least that far; the bound is rechecked as it shrinks.
+    if(vantageDistance < current.threshold) {
+        if(vantageDistance - bound(search) <= current.threshold) {
+            searchNode(current.inside, search);
+        }
+        if(vantageDistance + bound(search) >= current.threshold) {
+            searchNode(current.outside, search);
+        }
+    } else {
+        if(vantageDistance + bound(search) >= current.threshold) {
+            searchNode(current.outside, search);
+        }
+        if(vantageDistance - bound(search) <= current.threshold) {
+            searchNode(current.inside, search);
+        }
+    }
+}
+
+
+void VpTree::offer(const int point, const double distance, Search &search)
+{
+    if(point == search.excluded || distance > search.radius) {
+        return;
+    }
+    if(search.k > 0 && static_cast<int>(search.best.size()) == search.k) {
+        if(distance >= search.best.top().first) {
+            return;
+        }
+        search.best.pop();
+    }
+
+    search.best.push({distance, point});
+}
+
+
+double VpTree::bound(const Search &search)
+{
+    if(search.k > 0 && static_cast<int>(search.best.size()) == search.k) {
+        return std::min(search.radius, search.best.top().first);
+    }
+
+    return search.radius;
+}
+
+
+double VpTree::distance(const double *a, const double *b)
+{
+    int dimension = _points.getDimension();
+    double sum = 0;
+    if(_p == 2) {
+        for(int i = 0; i < dimension; i++) {
+            sum += (a[i] - b[i]) * (a[i] - b[i]);
+        }
+        return std::sqrt(sum);
+    }
+    if(_p == 1) {
+        for(int i = 0; i < dimension; i++) {
+            sum += std::abs(a[i] - b[i]);
+        }
+        return sum;
+    }
+
+    for(int i = 0; i < dimension; i++) {
+        sum += std::pow(std::abs(a[i] - b[i]), _p);
+    }
+    return std::pow(sum, 1.0 / _p);
+}
+
+
+void VpTree::normalize(const double *vector, const int dimension, double *normalized)
+{
+    double norm = 0;
+    for(int i = 0; i < dimension; i++) {
+        norm += vector[i] * vector[i];
+    }
+    norm = std::sqrt(norm);
+
+    for(int i = 0; i < dimension; i++) {
+        normalized[i] = qFuzzyIsNull(norm) ? 0 : vector[i] / norm;
+    }
+}
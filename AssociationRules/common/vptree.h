@@ -0,0 +1,93 @@
+#ifndef VPTREE_H
+#define VPTREE_H
+
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "vectorset.h"
+
+
+// Exact nearest neighbour index (vantage point tree) for Minkowski distances
+// with p >= 1, the range in which they satisfy the triangle inequality. Each
+// node splits its points at the median distance from a random vantage point;
+// a search descends into the side of the query first and skips the other side
+// whenever the triangle inequality proves that no point there can beat the
+// current k-th distance or the radius. Small subtrees are kept as leaf
+// buckets and scanned.
+//
+// Cosine mode normalises every vector to unit length and searches them with
+// p = 2: for unit vectors ||u - v||^2 = 2 - 2 cos(u, v), so the nearest
+// neighbours are the most similar ones. Zero vectors are left out of the
+// index and get no neighbours, as their cosine is undefined.
+class VpTree
+{
+public:
+    struct Neighbour
+    {
+        int index;
+        double distance;
+    };
+
+    // Constructors
+    VpTree(const double p, const bool cosine, const int threadsCount = 0);
+
+    // Getters
+    qint64 getDistancesCount();
+
+    // Functions
+    void build(const VectorSet &points);
+    QVector<Neighbour> search(const double *query, const int k, const double radius, const int excluded = -1);
+    QVector<QVector<Neighbour>> searchAll(const VectorSet &queries, const int k, const double radius, const bool excludeSelf);
+    double cosineSimilarity(const double distance);
+    double cosineRadius(const double minSimilarity);
+
+private:
+    struct Node
+    {
+        int point;
+        double threshold;
+        int inside;
+        int outside;
+        int begin;
+        int end;
+    };
+
+    struct Search
+    {
+        const double *query;
+        int k;
+        double radius;
+        int excluded;
+        std::priority_queue<std::pair<double, int>> best;
+        std::vector<double> normalized;
+        qint64 distancesCount;
+    };
+
+    // Fields
+    double _p;
+    bool _cosine;
+    int _threadsCount;
+    VectorSet _points;
+    std::vector<int> _order;
+    std::vector<Node> _nodes;
+    std::atomic<qint64> _distancesCount;
+
+    // Functions
+    int buildNode(const int begin, const int end, std::mt19937 &generator, std::vector<double> &distances);
+    void searchNode(const int node, Search &search);
+    void offer(const int point, const double distance, Search &search);
+    double bound(const Search &search);
+    double distance(const double *a, const double *b);
+    static void normalize(const double *vector, const int dimension, double *normalized);
+};
+
+
+#endif // VPTREE_H
@@ -1,9 +1,16 @@
 #include "mainwindow.h"
+#include "cli/commandline.h"
 
 #include <QApplication>
+#include <QCoreApplication>
 
 int main(int argc, char *argv[])
 {
+    if(CommandLine::isCommand(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        return CommandLine::run(a.arguments());
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
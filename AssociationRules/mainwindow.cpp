@@ -2,6 +2,7 @@
 #include "./ui_mainwindow.h"
 #include <QDebug>
 #include <cmath>
+#include <limits>
 #include <stdexcept>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -15,6 +16,14 @@ MainWindow::MainWindow(QWidget *parent)
     MainWindow::gridConfig();
     _frequentItemsetTab = new FrequentItemset();
     MainWindow::frequentItemsetConfig();
+    _distanceTab = new Distance();
+
+    // Phases are coarse enough for the GUI to record every run.
+    Profiler::setEnabled(true);
+
+    // ARULES_TRACE=<file> writes a Chrome trace of every run to that file.
+    _traceFilePath = qEnvironmentVariable("ARULES_TRACE");
+    Tracer::setEnabled(!_traceFilePath.isEmpty());
 
     connect(ui->gridBrowseButton, &QPushButton::clicked, this, &MainWindow::gridOnBrowseButtonClicked);
     connect(ui->gridChangeButton, &QPushButton::clicked, this, &MainWindow::gridOnChangeButtonClicked);
@@ -27,6 +36,7 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->pbChooseVec1, &QPushButton::clicked, this, &MainWindow::pbChooseVector1);
     connect(ui->pbChooseVec2, &QPushButton::clicked, this, &MainWindow::pbChooseVector2);
     connect(ui->pbCompute, &QPushButton::clicked, this, &MainWindow::pbCompute);
+    connect(ui->pbChooseMatrixOutput, &QPushButton::clicked, this, &MainWindow::pbChooseMatrixOutput);
     connect(ui->comboBox, &QComboBox::currentTextChanged, this, &MainWindow::changeParams);
     connect(ui->pbChooseApr, &QPushButton::clicked, this, &MainWindow::pbChooseApr);
     connect(ui->pbFindRare, &QPushButton::clicked, this, &MainWindow::pbFindRare);
@@ -50,25 +60,27 @@ void MainWindow::gridConfig()
     QTableWidgetItem *headerItem3 = new QTableWidgetItem(QString("Example"), QTableWidgetItem::Type);
     ui->gridParametersTable->setHorizontalHeaderItem(2, headerItem3);
 
-    QTableWidgetItem *headerItem4 = new QTableWidgetItem(QString(""), QTableWidgetItem::Type);
-    ui->gridParametersTable->setItem(0, 1, headerItem4);
+    int rowCount = ui->gridParametersTable->rowCount();
+    for(int row = 0; row < rowCount; row++) {
+        QTableWidgetItem *valueCell = new QTableWidgetItem(QString(""), QTableWidgetItem::Type);
+        ui->gridParametersTable->setItem(row, 1, valueCell);
 
-    QTableWidgetItem *parameterCell = ui->gridParametersTable->item(0, 0);
-    if(parameterCell) {
-        parameterCell->setFlags(parameterCell->flags() & ~Qt::ItemIsEditable);
-    } else {
-        QMessageBox::critical(this, "Error", "Problem with getting parameter cell");
-    }
+        QTableWidgetItem *parameterCell = ui->gridParametersTable->item(row, 0);
+        if(parameterCell) {
+            parameterCell->setFlags(parameterCell->flags() & ~Qt::ItemIsEditable);
+        } else {
+            QMessageBox::critical(this, "Error", "Problem with getting parameter cell");
+        }
 
-    QTableWidgetItem *exampleCell = ui->gridParametersTable->item(0, 2);
-    if(exampleCell) {
-        exampleCell->setFlags(exampleCell->flags() & ~Qt::ItemIsEditable);
-    } else {
-        QMessageBox::critical(this, "Error", "Problem with getting example cell");
+        QTableWidgetItem *exampleCell = ui->gridParametersTable->item(row, 2);
+        if(exampleCell) {
+            exampleCell->setFlags(exampleCell->flags() & ~Qt::ItemIsEditable);
+        } else {
+            QMessageBox::critical(this, "Error", "Problem with getting example cell");
+        }
     }
 
     ui->gridParametersTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    int rowCount = ui->gridParametersTable->rowCount();
     int columnCount = ui->gridParametersTable->columnCount();
 
     for(int row = 0; row < rowCount; row++) {
@@ -105,11 +117,76 @@ void MainWindow::gridOnRunAlgorithmButtonClicked()
     setCursor(Qt::WaitCursor);
     ui->gridRunAlgorithmButton->setDisabled(true);
     QCoreApplication::processEvents();
+    Profiler::reset();
+
+    double topK;
+    if(!readOptionalParameter(ui->gridParametersTable, 5, topK) || topK < 0 || topK != std::floor(topK)) {
+        QMessageBox::critical(this, "Error", "Top-k must be a positive integer");
+
+        setCursor(Qt::ArrowCursor);
+        ui->gridRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+
+    double topKClosed;
+    if(!readOptionalParameter(ui->gridParametersTable, 6, topKClosed) || (topKClosed != 0 && topKClosed != 1)) {
+        QMessageBox::critical(this, "Error", "Top-k closed must be 0 or 1");
+
+        setCursor(Qt::ArrowCursor);
+        ui->gridRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+    _gridTab->setTopK(static_cast<int>(topK), topKClosed == 1);
+
+    QSet<int> requiredItems;
+    if(!readItemsParameter(ui->gridParametersTable, 7, requiredItems)) {
+        QMessageBox::critical(this, "Error", "Include items must be integers separated by spaces");
+
+        setCursor(Qt::ArrowCursor);
+        ui->gridRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+
+    QSet<int> excludedItems;
+    if(!readItemsParameter(ui->gridParametersTable, 8, excludedItems)) {
+        QMessageBox::critical(this, "Error", "Exclude items must be integers separated by spaces");
+
+        setCursor(Qt::ArrowCursor);
+        ui->gridRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+
+    if(requiredItems.intersects(excludedItems)) {
+        QMessageBox::critical(this, "Error", "An item cannot be both included and excluded");
+
+        setCursor(Qt::ArrowCursor);
+        ui->gridRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+
+    if(topK > 0 && !requiredItems.isEmpty()) {
+        QMessageBox::critical(this, "Error", "Top-k cannot be combined with included items");
+
+        setCursor(Qt::ArrowCursor);
+        ui->gridRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+
+    ItemConstraints constraints;
+    constraints.setRequiredItems(requiredItems);
+    constraints.setExcludedItems(excludedItems);
+    _gridTab->setItemConstraints(constraints);
 
     QTableWidgetItem *minSupCell = ui->gridParametersTable->item(0, 1);
     if(minSupCell) {
         QString cellText = minSupCell->text().trimmed().replace(",", ".");
-        if(cellText == "") {
+        if(cellText == "" && topK == 0) {
             QMessageBox::critical(this, "Error", "Minimum support not entered");
 
             setCursor(Qt::ArrowCursor);
@@ -118,8 +195,12 @@ void MainWindow::gridOnRunAlgorithmButtonClicked()
             return;
         }
 
-        bool success;
-        float minSup = cellText.toFloat(&success);
+        // With top-k the minimum support is found by the miner.
+        bool success = true;
+        float minSup = 1;
+        if(cellText != "") {
+            minSup = cellText.toFloat(&success);
+        }
 
         if(success) {
             if(minSup <= 0 || minSup > 1) {
@@ -131,7 +212,64 @@ void MainWindow::gridOnRunAlgorithmButtonClicked()
                 return;
             }
 
+            double memoryBudget;
+            if(!readOptionalParameter(ui->gridParametersTable, 1, memoryBudget) || memoryBudget < 0) {
+                QMessageBox::critical(this, "Error", "Memory budget must be a non-negative number of megabytes");
+
+                setCursor(Qt::ArrowCursor);
+                ui->gridRunAlgorithmButton->setDisabled(false);
+
+                return;
+            }
+            _gridTab->setMemoryBudget(static_cast<qint64>(memoryBudget * 1024 * 1024));
+
+            double workersCount;
+            if(!readOptionalParameter(ui->gridParametersTable, 2, workersCount)
+                || workersCount < 0 || workersCount != std::floor(workersCount)) {
+                QMessageBox::critical(this, "Error", "Worker processes must be a positive integer");
+
+                setCursor(Qt::ArrowCursor);
+                ui->gridRunAlgorithmButton->setDisabled(false);
+
+                return;
+            }
+            _gridTab->setWorkersCount(std::max(1, static_cast<int>(workersCount)));
+
+            double incremental;
+            if(!readOptionalParameter(ui->gridParametersTable, 3, incremental) || (incremental != 0 && incremental != 1)) {
+                QMessageBox::critical(this, "Error", "Incremental update must be 0 or 1");
+
+                setCursor(Qt::ArrowCursor);
+                ui->gridRunAlgorithmButton->setDisabled(false);
+
+                return;
+            }
+            _gridTab->setIncremental(incremental == 1);
+
+            double sampleSize;
+            if(!readOptionalParameter(ui->gridParametersTable, 4, sampleSize)
+                || sampleSize < 0 || sampleSize != std::floor(sampleSize)) {
+                QMessageBox::critical(this, "Error", "Sample size must be a positive integer");
+
+                setCursor(Qt::ArrowCursor);
+                ui->gridRunAlgorithmButton->setDisabled(false);
+
+                return;
+            }
+            _gridTab->setSampleSize(static_cast<int>(sampleSize));
+
+            bool inMemoryOnly = topK > 0 || !constraints.isEmpty();
+            if(inMemoryOnly && (memoryBudget > 0 || workersCount > 1 || incremental == 1 || sampleSize > 0)) {
+                QMessageBox::critical(this, "Error", "Top-k and item constraints run in memory and cannot be combined with other modes");
+
+                setCursor(Qt::ArrowCursor);
+                ui->gridRunAlgorithmButton->setDisabled(false);
+
+                return;
+            }
+
             _gridTab->onRunAlgorithmButtonClicked(_gridScene, minSup);
+            showProfile();
         } else {
             QMessageBox::critical(this, "Error", "Minimum support must be number (float or integer)");
         }
@@ -144,6 +282,53 @@ void MainWindow::gridOnRunAlgorithmButtonClicked()
 }
 
 
+bool MainWindow::readOptionalParameter(QTableWidget *table, int row, double &value)
+{
+    value = 0;
+
+    QTableWidgetItem *cell = table->item(row, 1);
+    if(!cell) {
+        return true;
+    }
+
+    QString cellText = cell->text().trimmed().replace(",", ".");
+    if(cellText == "") {
+        return true;
+    }
+
+    bool success;
+    value = cellText.toDouble(&success);
+
+    return success;
+}
+
+
+void MainWindow::showProfile()
+{
+    // The status bar holds the phase times, its tooltip the full report.
+    ui->statusbar->showMessage(Profiler::summary());
+    ui->statusbar->setToolTip(Profiler::report());
+
+    QString errorString;
+    if(!_traceFilePath.isEmpty() && !Tracer::writeJson(_traceFilePath, errorString)) {
+        ui->statusbar->showMessage(errorString);
+    }
+}
+
+
+bool MainWindow::readItemsParameter(QTableWidget *table, int row, QSet<int> &items)
+{
+    items.clear();
+
+    QTableWidgetItem *cell = table->item(row, 1);
+    if(!cell) {
+        return true;
+    }
+
+    return ItemConstraints::parseItems(cell->text().trimmed(), items);
+}
+
+
 void MainWindow::frequentItemsetConfig()
 {
     QString inputFilePath = _frequentItemsetTab->getInputFilePath();
@@ -160,21 +345,23 @@ void MainWindow::frequentItemsetConfig()
     QTableWidgetItem *headerItem3 = new QTableWidgetItem(QString("Example"), QTableWidgetItem::Type);
     ui->freqParametersTable->setHorizontalHeaderItem(2, headerItem3);
 
-    QTableWidgetItem *headerItem4 = new QTableWidgetItem(QString(""), QTableWidgetItem::Type);
-    ui->freqParametersTable->setItem(0, 1, headerItem4);
+    for(int row = 0; row < ui->freqParametersTable->rowCount(); row++) {
+        QTableWidgetItem *valueCell = new QTableWidgetItem(QString(""), QTableWidgetItem::Type);
+        ui->freqParametersTable->setItem(row, 1, valueCell);
 
-    QTableWidgetItem *parameterCell = ui->freqParametersTable->item(0, 0);
-    if(parameterCell) {
-        parameterCell->setFlags(parameterCell->flags() & ~Qt::ItemIsEditable);
-    } else {
-        QMessageBox::critical(this, "Error", "Problem with getting parameter cell");
-    }
+        QTableWidgetItem *parameterCell = ui->freqParametersTable->item(row, 0);
+        if(parameterCell) {
+            parameterCell->setFlags(parameterCell->flags() & ~Qt::ItemIsEditable);
+        } else {
+            QMessageBox::critical(this, "Error", "Problem with getting parameter cell");
+        }
 
-    QTableWidgetItem *exampleCell = ui->freqParametersTable->item(0, 2);
-    if(exampleCell) {
-        exampleCell->setFlags(exampleCell->flags() & ~Qt::ItemIsEditable);
-    } else {
-        QMessageBox::critical(this, "Error", "Problem with getting example cell");
+        QTableWidgetItem *exampleCell = ui->freqParametersTable->item(row, 2);
+        if(exampleCell) {
+            exampleCell->setFlags(exampleCell->flags() & ~Qt::ItemIsEditable);
+        } else {
+            QMessageBox::critical(this, "Error", "Problem with getting example cell");
+        }
     }
 
     ui->freqParametersTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
@@ -210,47 +397,8 @@ double MainWindow::minkowskiDistance(const QVector<double> &vec1, const QVector<
 
 double MainWindow::mahalanobisDistance(const QVector<double> &vec1, const QVector<double> &vec2)
 {
-    int n = vec1.size();
-    // 1. Napravi 2xN matricu od vektora
-    QVector<QVector<double>> data = {vec1, vec2};
-    // 2. Izračunaj srednju vrednost po koloni
-    QVector<double> mean(n, 0.0);
-    for (int i = 0; i < n; ++i) {
-        mean[i] = (vec1[i] + vec2[i]) / 2.0;
-    }
-    // 3. Izračunaj kovarijacionu matricu (n x n)
-    QVector<QVector<double>> covMatrix(n, QVector<double>(n, 0.0));
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            double sum = 0.0;
-            for (int k = 0; k < 2; ++k) {  // 2 vektora
-                sum += (data[k][i] - mean[i]) * (data[k][j] - mean[j]);
-            }
-            covMatrix[i][j] = sum / 1.0;  // delimo sa (2 - 1) = 1
-        }
-    }// 4. Inverzija kovarijacione matrice (pretpostavimo dijagonalnu za jednostavnost)
-    QVector<QVector<double>> invCovMatrix(n, QVector<double>(n, 0.0));
-    for (int i = 0; i < n; ++i) {
-        if (covMatrix[i][i] == 0.0) {
-            throw std::runtime_error("Covariance matrix is singular.");
-        }
-        invCovMatrix[i][i] = 1.0 / covMatrix[i][i];
-    }// 5. diff = vec1 - vec2
-    QVector<double> diff(n);
-    for (int i = 0; i < n; ++i) {
-        diff[i] = vec1[i] - vec2[i];
-    }// 6. temp = invCovMatrix * diff
-    QVector<double> temp(n, 0.0);
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            temp[i] += invCovMatrix[i][j] * diff[j];
-        }
-    }// 7. distance = sqrt(diff^T * temp)
-    double distance = 0.0;
-    for (int i = 0; i < n; ++i) {
-        distance += diff[i] * temp[i];
-    }
-    return std::sqrt(distance);
+    // Kovarijansa i njen Cholesky faktor se racunaju jednom, iz referentnog skupa
+    return _distanceTab->getMahalanobis().distance(vec1.constData(), vec2.constData());
 }
 
 double MainWindow::cosineDistance(const QVector<double> &vec1, const QVector<double> &vec2)
@@ -285,86 +433,40 @@ double MainWindow::cosineDistance(const QVector<double> &vec1, const QVector<dou
     return similarity;
 }
 
-int MainWindow::hammingDistance(const QVector<double> &vec1, const QVector<double> &vec2)
+int MainWindow::hammingDistance(const BitVectorSet &vectors)
 {
-    if (vec1.size() != vec2.size()) {
-        qWarning() << "Vektori nisu iste duzine!";
-        return -1;
-    }
-
-    int distance = 0;
-    for (int i = 0; i < vec1.size(); ++i) {
-        // Pretpostavljamo da su vrednosti 0 ili 1, pa samo proveravamo razliku
-        if (vec1[i] != vec2[i]) {
-            distance++;  // Povećaj rastojanje ako su vrednosti različite
-        }
-    }
-
-    return distance;
+    // Vektori su spakovani u bitove, rastojanje je popcount(vec1 XOR vec2)
+    return BitVectorSet::hammingDistance(vectors.getRow(0), vectors.getRow(1), vectors.getWordsCount());
 }
 
-double MainWindow::jaccardCoefficient(const QVector<double> &vec1, const QVector<double> &vec2)
+double MainWindow::jaccardCoefficient(const BitVectorSet &vectors)
 {
-    if (vec1.size() != vec2.size()) {
-        qWarning() << "Vektori nisu iste dužine!";
-            return -1.0;  // Greška
-    }
-
-    int m11 = 0; // Broj pozicija gde su oba 1
-    int m10 = 0; // Broj pozicija gde je vec1=1, vec2=0
-    int m01 = 0; // Broj pozicija gde je vec1=0, vec2=1
-
-    for (int i = 0; i < vec1.size(); ++i) {
-        if (vec1[i] == 1.0 && vec2[i] == 1.0) {
-            m11++;
-        } else if (vec1[i] == 1.0 && vec2[i] == 0.0) {
-            m10++;
-        } else if (vec1[i] == 0.0 && vec2[i] == 1.0) {
-            m01++;
-        }
-
-    }
-
-    int denominator = m11 + m10 + m01;
-    if (denominator == 0) {
-        return 0.0;  // Da se izbegne deljenje nulom
-    }
-    qDebug()<<m11<<m10<<m01<<denominator<< static_cast<double>(m11)<<static_cast<double>(m11) / denominator<<1 - static_cast<double>(m11) / denominator;
-    return  static_cast<double>(m11) / denominator;
+    // popcount(vec1 AND vec2) / popcount(vec1 OR vec2)
+    return BitVectorSet::jaccardCoefficient(vectors.getRow(0), vectors.getRow(1), vectors.getWordsCount());
 }
 
 
-QVector<double> MainWindow::parseVector(const QString &filePath)
+bool MainWindow::parseVector(const QString &filePath, QVector<double> &vector)
 {
-    QVector<double> vector;
-    QFile file(filePath);
+    vector.clear();
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    // Redovi fajla se nadovezuju u jedan vektor
+    VectorReader reader(filePath);
+    if (!reader.open()) {
         ui->leRes->setText("ERROR: The file could not be opened. Please make sure you have selected the correct file with corrected form or entered a valid path.");
-        qWarning() << "Error opening file:" << filePath;
-        return vector;
-    }
-
-    QTextStream stream(&file);
-    while (!stream.atEnd()) {
-        QString line = stream.readLine();
-        QStringList numbers = line.split(",");
-        for (const QString& num : numbers) {
-            bool ok;
-            double value = num.toDouble(&ok);
-            qDebug()<<value;
-            if (ok) {
-                vector.append(value);
-            } else {
-                ui->leRes->setText("ERROR: The file could not be opened. Please make sure you have selected the correct file with corrected form or entered a valid path.");
-                qWarning() << "Failed to parse number:" << num;
+        return false;
+    }
 
-            }
-        }
+    QVector<double> row;
+    while (reader.next(row)) {
+        vector.append(row);
     }
 
-    file.close();
-    return vector;
+    if (reader.hasError()) {
+        ui->leRes->setText("ERROR: " + filePath + ": " + reader.getErrorString());
+        return false;
+    }
+    return true;
 }
 #include <QtAlgorithms>
 uint qHash(const QSet<int> &key, uint seed = 0) {
@@ -403,29 +505,200 @@ void MainWindow::findRareItemsets(const QString &filename) {
     double MIN_SUPPORT = ui->leMinSupp->text().toDouble();
     QString output1 = ui->lePbOutputRare->text();
 
-    // --- 1. Učitavanje transakcija
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Ne mogu da otvorim fajl!";
-        return;
+    using Itemset = QVector<int>;
+    QMap<Itemset,int> minimalRare;
+    QString summary;
+    QString header;
+    Profiler::reset();
+    if (ui->cbRareAlgorithm->currentText() == "Toivonen sampling") {
+        if (!findRareItemsetsBySampling(filename, MIN_SUPPORT, minimalRare, summary))
+            return;
+    } else if (ui->cbRareAlgorithm->currentText() == "RP-Growth") {
+        if (!findRareItemsetsByRPGrowth(filename, MIN_SUPPORT, minimalRare, summary, header))
+            return;
+    } else if (ui->cbRareAlgorithm->currentText() == "MRG-Exp") {
+        if (!findRareItemsetsByMRGExp(filename, MIN_SUPPORT, minimalRare, summary))
+            return;
+    } else {
+        if (!findAprioriRare(filename, MIN_SUPPORT, minimalRare)) {
+            QMessageBox::critical(this, "Error", "Unable to open the input file " + filename);
+            return;
+        }
+    }
+    PROFILE_COUNT("itemsets emitted", minimalRare.size());
+
+    // --- 7. Ispis
+    QFile outF(output1);
+    if (!outF.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Ne mogu da otvorim izlazni fajl:" << output1;
+    } else {
+        PROFILE_SCOPE("save");
+        QTextStream out(&outF);
+        if (!header.isEmpty())
+            out << header << "\n";
+        for (auto it = minimalRare.constBegin(); it != minimalRare.constEnd(); ++it) {
+            QString s;
+            for (int v : it.key()) s += QString::number(v) + " ";
+            out << s.trimmed() << " #SUP: " << it.value() << "\n";
+        }
+        outF.close();
+    }
+
+    QString preview = summary;
+    for (auto it = minimalRare.constBegin(); it != minimalRare.constEnd(); ++it) {
+        QString s;
+        for (int v : it.key()) s += QString::number(v) + " ";
+        preview += "{" + s.trimmed() + "} -> " + QString::number(it.value()) + "\n";
+    }
+    ui->textEdit->setText(preview);
+    showProfile();
+}
+
+
+bool MainWindow::findRareItemsetsBySampling(const QString &filename, double minSupport,
+                                            QMap<QVector<int>,int> &minimalRare, QString &summary) {
+    // Toivonen: uzorak se rudari sa snizenim pragom, negativna granica se proverava u jednom prolazu
+    bool ok;
+    int sampleSize = ui->leSampleSize->text().trimmed().toInt(&ok);
+    if (ui->leSampleSize->text().trimmed().isEmpty()) {
+        sampleSize = 10000;
+    } else if (!ok || sampleSize <= 0) {
+        QMessageBox::critical(this, "Error", "Sample size must be a positive integer");
+        return false;
+    }
+
+    SamplingMiner miner(filename, sampleSize);
+    QMap<QVector<int>,int> frequentItemsets;
+    if (!miner.mine(minSupport, frequentItemsets, minimalRare)) {
+        QMessageBox::critical(this, "Error", miner.getErrorString());
+        return false;
+    }
+
+    summary = QString("Sample: %1 of %2 transactions, lowered support %3\n")
+                  .arg(miner.getSampleCount())
+                  .arg(miner.getTransactionsCount())
+                  .arg(miner.getLoweredSupport());
+    if (miner.isFallbackUsed()) {
+        summary += "A border itemset was frequent: exact fallback pass was required\n\n";
+    } else {
+        summary += QString("Negative border verified in %1 pass(es)\n\n").arg(miner.getPassesCount());
+    }
+
+    return true;
+}
+
+
+bool MainWindow::findRareItemsetsByRPGrowth(const QString &filename, double minSupport,
+                                            QMap<QVector<int>,int> &rareItemsets, QString &summary,
+                                            QString &header) {
+    // RP-Growth: u RP-stablo ulaze samo transakcije sa bar jednom retkom stavkom
+    QString minRareText = ui->leMinRareSupp->text().trimmed().replace(",", ".");
+    bool ok = true;
+    double minRareSupport = minRareText.isEmpty() ? 0 : minRareText.toDouble(&ok);
+    if (!ok || minRareSupport < 0 || minRareSupport >= minSupport) {
+        QMessageBox::critical(this, "Error", "Min rare support must be in scope [0, min support)");
+        return false;
+    }
+
+    QVector<QVector<int>> database;
+    if (!loadRareDatabase(filename, database)) {
+        QMessageBox::critical(this, "Error", "Unable to open the input file " + filename);
+        return false;
     }
-    QTextStream in(&file);
 
+    PROFILE_SCOPE("mine");
+    RPGrowth rpGrowth;
+    rareItemsets = rpGrowth.mine(database, minRareSupport, minSupport);
+
+    // RP-Growth vraća sve retke skupove iz opsega, ne samo minimalne; svaki
+    // od njih sadrži retku stavku, pa bi minimalni bili samo retke stavke.
+    header = QString("Rare itemsets with support in [%1, %2), not only the minimal ones")
+                 .arg(minRareSupport)
+                 .arg(minSupport);
+    summary = QString("RP-Growth: rare itemsets with support in [%1, %2), %3 of %4 transactions in the RP-tree (%5 nodes)\n\n")
+                  .arg(minRareSupport)
+                  .arg(minSupport)
+                  .arg(rpGrowth.getTreeTransactionsCount())
+                  .arg(database.size())
+                  .arg(rpGrowth.getNodesCount());
+
+    return true;
+}
+
+
+bool MainWindow::findRareItemsetsByMRGExp(const QString &filename, double minSupport,
+                                          QMap<QVector<int>,int> &minimalRare, QString &summary) {
+    // MRG-Exp: pretraga ide samo kroz ceste generatore, retki kandidati su odmah minimalni
     QVector<QVector<int>> database;
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        if (line.isEmpty() || line.startsWith('#') || line.startsWith('%') || line.startsWith('@'))
-            continue;
-        QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-        QVector<int> transaction;
-        for (auto &p : parts) {
-            transaction.append(p.toInt());
+    if (!loadRareDatabase(filename, database)) {
+        QMessageBox::critical(this, "Error", "Unable to open the input file " + filename);
+        return false;
+    }
+
+    PROFILE_SCOPE("mine");
+    int minsupAbsolute = int(std::ceil(minSupport * database.size()));
+    MRGExp mrgExp;
+    minimalRare = mrgExp.mine(database, minsupAbsolute);
+
+    summary = QString("MRG-Exp: %1 frequent generators explored\n\n").arg(mrgExp.getFrequentGeneratorsCount());
+
+    return true;
+}
+
+
+bool MainWindow::loadRareDatabase(const QString &filename, QVector<QVector<int>> &database) {
+    // --- 1. Učitavanje transakcija (binarni keš ako je ažuran)
+    PROFILE_SCOPE("read");
+    TransactionCache cache(filename);
+    if (!cache.load(database)) {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qWarning() << "Ne mogu da otvorim fajl!";
+            return false;
+        }
+        PROFILE_COUNT("bytes parsed", file.size());
+        QTextStream in(&file);
+
+        // Ovaj parser preskače prazne i komentarisane linije, a ostali tabovi
+        // takav fajl odbijaju; keš se zato piše samo za fajl koji bi i oni
+        // prihvatili, jer ga učitavaju bez ponovne provere.
+        bool isStrict = true;
+        while (!in.atEnd()) {
+            QString line = in.readLine().trimmed();
+            if (line.isEmpty() || line.startsWith('#') || line.startsWith('%') || line.startsWith('@')) {
+                isStrict = false;
+                continue;
+            }
+            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+            QVector<int> transaction;
+            for (auto &p : parts) {
+                bool isNumber = false;
+                transaction.append(p.toInt(&isNumber));
+                isStrict = isStrict && isNumber;
+            }
+            std::sort(transaction.begin(), transaction.end());
+            database.append(transaction);
         }
-        std::sort(transaction.begin(), transaction.end());
-        database.append(transaction);
+        file.close();
+
+        if (isStrict)
+            cache.save(database);
     }
-    file.close();
+    PROFILE_COUNT("transactions scanned", database.size());
+
+    return true;
+}
 
+
+bool MainWindow::findAprioriRare(const QString &filename, double MIN_SUPPORT,
+                                 QMap<QVector<int>,int> &minimalRare) {
+    minimalRare.clear();
+
+    QVector<QVector<int>> database;
+    if (!loadRareDatabase(filename, database))
+        return false;
+
+    PROFILE_SCOPE("mine");
     int databaseSize = database.size();
     int minsupAbsolute = int(std::ceil(MIN_SUPPORT * databaseSize));
 
@@ -473,10 +746,12 @@ void MainWindow::findRareItemsets(const QString &filename) {
     QVector<Itemset> levelK_1;
     int k = 2;
     while (!candidates.isEmpty()) {
+        TRACE_SCOPE_VALUE("count level", "k", k);
         // reset podrške
         for (auto &c : candidates) c.second = 0;
 
         // scan DB i broj podrške
+        PROFILE_COUNT("candidates generated", candidates.size());
         for (auto &t : database) {
             for (auto &c : candidates) {
                 const Itemset &ci = c.first;
@@ -524,7 +799,6 @@ void MainWindow::findRareItemsets(const QString &filename) {
     }
 
     // --- 6. Filtriraj minimalističke retke skupove
-    QMap<Itemset,int> minimalRare;
     for (auto it = supportCount.constBegin(); it != supportCount.constEnd(); ++it) {
         const Itemset &iset = it.key();
         bool minimal = true;
@@ -536,32 +810,7 @@ void MainWindow::findRareItemsets(const QString &filename) {
         if (minimal) minimalRare[iset] = it.value();
     }
 
-    // --- 7. Ispis
-    qDebug() << "Minimalni retki skupovi (<" << minsupAbsolute << "):";
-    for (auto it = minimalRare.constBegin(); it != minimalRare.constEnd(); ++it) {
-        qDebug() << it.key() << "#SUP:" << it.value();
-    }
-
-    QFile outF(output1);
-    if (!outF.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Ne mogu da otvorim izlazni fajl:" << output1;
-    } else {
-        QTextStream out(&outF);
-        for (auto it = minimalRare.constBegin(); it != minimalRare.constEnd(); ++it) {
-            QString s;
-            for (int v : it.key()) s += QString::number(v) + " ";
-            out << s.trimmed() << " #SUP: " << it.value() << "\n";
-        }
-        outF.close();
-    }
-
-    QString preview;
-    for (auto it = minimalRare.constBegin(); it != minimalRare.constEnd(); ++it) {
-        QString s;
-        for (int v : it.key()) s += QString::number(v) + " ";
-        preview += "{" + s.trimmed() + "} -> " + QString::number(it.value()) + "\n";
-    }
-    ui->textEdit->setText(preview);
+    return true;
 }
 
 
@@ -585,11 +834,78 @@ void MainWindow::freqOnRunAlgorithmButtonClicked()
     setCursor(Qt::WaitCursor);
     ui->freqRunAlgorithmButton->setDisabled(true);
     QCoreApplication::processEvents();
+    Profiler::reset();
+
+    double topK;
+    if(!readOptionalParameter(ui->freqParametersTable, 1, topK) || topK < 0 || topK != std::floor(topK)) {
+        QMessageBox::critical(this, "Error", "Top-k must be a positive integer");
+
+        setCursor(Qt::ArrowCursor);
+        ui->freqRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+    _frequentItemsetTab->setTopK(static_cast<int>(topK));
+
+    QSet<int> requiredItems;
+    if(!readItemsParameter(ui->freqParametersTable, 2, requiredItems)) {
+        QMessageBox::critical(this, "Error", "Include items must be integers separated by spaces");
+
+        setCursor(Qt::ArrowCursor);
+        ui->freqRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+
+    QSet<int> excludedItems;
+    if(!readItemsParameter(ui->freqParametersTable, 3, excludedItems)) {
+        QMessageBox::critical(this, "Error", "Exclude items must be integers separated by spaces");
+
+        setCursor(Qt::ArrowCursor);
+        ui->freqRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+
+    if(requiredItems.intersects(excludedItems)) {
+        QMessageBox::critical(this, "Error", "An item cannot be both included and excluded");
+
+        setCursor(Qt::ArrowCursor);
+        ui->freqRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+
+    if(topK > 0 && !requiredItems.isEmpty()) {
+        QMessageBox::critical(this, "Error", "Top-k cannot be combined with included items");
+
+        setCursor(Qt::ArrowCursor);
+        ui->freqRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+
+    ItemConstraints constraints;
+    constraints.setRequiredItems(requiredItems);
+    constraints.setExcludedItems(excludedItems);
+    _frequentItemsetTab->setItemConstraints(constraints);
+
+    double threadsCount;
+    if(!readOptionalParameter(ui->freqParametersTable, 4, threadsCount)
+        || threadsCount < 0 || threadsCount != std::floor(threadsCount)) {
+        QMessageBox::critical(this, "Error", "Threads must be a positive integer");
+
+        setCursor(Qt::ArrowCursor);
+        ui->freqRunAlgorithmButton->setDisabled(false);
+
+        return;
+    }
+    _frequentItemsetTab->setThreadsCount(static_cast<int>(threadsCount));
 
     QTableWidgetItem *minSupCell = ui->freqParametersTable->item(0, 1);
     if(minSupCell) {
         QString cellText = minSupCell->text().trimmed().replace(",", ".");
-        if(cellText == "") {
+        if(cellText == "" && topK == 0) {
             QMessageBox::critical(this, "Error", "Minimum support not entered");
 
             setCursor(Qt::ArrowCursor);
@@ -598,8 +914,12 @@ void MainWindow::freqOnRunAlgorithmButtonClicked()
             return;
         }
 
-        bool success;
-        float minSup = cellText.toFloat(&success);
+        // With top-k the minimum support is found by the miner.
+        bool success = true;
+        float minSup = 1;
+        if(cellText != "") {
+            minSup = cellText.toFloat(&success);
+        }
 
         if(success) {
             if(minSup <= 0 || minSup > 1) {
@@ -612,6 +932,7 @@ void MainWindow::freqOnRunAlgorithmButtonClicked()
             }
 
             _frequentItemsetTab->onRunAlgorithmButtonClicked(_frequentItemsetScene, minSup);
+            showProfile();
         } else {
             QMessageBox::critical(this, "Error", "Minimum support must be number (float or integer)");
         }
@@ -629,14 +950,23 @@ void MainWindow::freqOnForwardButtonClicked()
     setCursor(Qt::WaitCursor);
     _frequentItemsetTab->onForwardButtonClicked(_frequentItemsetScene);
     setCursor(Qt::ArrowCursor);
+
+    // Forward steps add to the phases of the run they continue.
+    showProfile();
 }
 
 void MainWindow::changeParams()
 {
+    ui->leParam->setPlaceholderText("");
     if (ui->comboBox->currentText() == "Minkowski Distance"){
         ui->leParam->setReadOnly(false);
         ui->leParam->setText("");
     }
+    else if (ui->comboBox->currentText() == "Mahalanobis Distance"){
+        ui->leParam->setReadOnly(false);
+        ui->leParam->setText("");
+        ui->leParam->setPlaceholderText("Reference dataset file (one vector per line)");
+    }
     else{
         ui->leParam->setText("There is no parameter defined for this distance.");
         ui->leParam->setReadOnly(true);
@@ -656,14 +986,109 @@ void MainWindow::pbChooseVector2()
     ui->leVec2->setText(filePath);
 }
 
+void MainWindow::pbChooseMatrixOutput()
+{
+    QString filePath = _frequentItemsetTab->onBrowseButtonClicked();
+    ui->leMatrixOutput->setText(filePath);
+}
+
+void MainWindow::computeDistanceMatrix()
+{
+    QString dist = ui->comboBox->currentText();
+    DistanceMatrix::Metric metric = DistanceMatrix::Minkowski;
+    if (dist == "Cosine Distance") {
+        metric = DistanceMatrix::Cosine;
+    } else if (dist == "Hamming Distance") {
+        metric = DistanceMatrix::Hamming;
+    } else if (dist == "Jaccard coefficient") {
+        metric = DistanceMatrix::Jaccard;
+    } else if (dist == "Mahalanobis Distance") {
+        metric = DistanceMatrix::Mahalanobis;
+        if (!_distanceTab->loadReference(ui->leParam->text().trimmed())) {
+            ui->leRes->setText("ERROR: " + _distanceTab->getErrorString());
+            return;
+        }
+    }
+
+    double p = 2;
+    if (metric == DistanceMatrix::Minkowski) {
+        bool ok;
+        p = ui->leParam->text().toDouble(&ok);
+        if (!ok || p <= 0) {
+            ui->leRes->setText("ERROR: Parameter p must be a positive number.");
+            return;
+        }
+    }
+
+    int threadsCount = 0;
+    if (!ui->leThreads->text().trimmed().isEmpty()) {
+        bool ok;
+        threadsCount = ui->leThreads->text().trimmed().toInt(&ok);
+        if (!ok || threadsCount <= 0) {
+            ui->leRes->setText("ERROR: Threads must be a positive integer.");
+            return;
+        }
+    }
+
+    int k = 0;
+    if (!ui->leNeighbours->text().trimmed().isEmpty()) {
+        bool ok;
+        k = ui->leNeighbours->text().trimmed().toInt(&ok);
+        if (!ok || k <= 0) {
+            ui->leRes->setText("ERROR: Nearest k must be a positive integer.");
+            return;
+        }
+    }
+
+    double radius = std::numeric_limits<double>::infinity();
+    bool hasRadius = !ui->leRadius->text().trimmed().isEmpty();
+    if (hasRadius) {
+        bool ok;
+        radius = ui->leRadius->text().trimmed().toDouble(&ok);
+        if (!ok || (metric != DistanceMatrix::Cosine && radius < 0)) {
+            ui->leRes->setText("ERROR: Radius must be a non-negative number.");
+            return;
+        }
+    }
+
+    if (ui->leMatrixOutput->text().isEmpty()) {
+        ui->leRes->setText("ERROR: Choose a file for the output matrix.");
+        return;
+    }
+
+    setCursor(Qt::WaitCursor);
+    bool success;
+    if (k > 0 || hasRadius) {
+        success = _distanceTab->computeNeighbours(metric, p, threadsCount, k, radius,
+                                                  ui->leVec1->text(), ui->leVec2->text().trimmed(),
+                                                  ui->leMatrixOutput->text());
+    } else {
+        success = _distanceTab->computeMatrix(metric, p, threadsCount,
+                                              ui->leVec1->text(), ui->leVec2->text().trimmed(),
+                                              ui->leMatrixOutput->text());
+    }
+    setCursor(Qt::ArrowCursor);
+
+    if (!success) {
+        ui->leRes->setText("ERROR: " + _distanceTab->getErrorString());
+        return;
+    }
+    ui->leRes->setText(_distanceTab->getSummary());
+}
+
 void MainWindow::pbCompute()
 {
+    if (ui->cbBatch->isChecked()) {
+        MainWindow::computeDistanceMatrix();
+        return;
+    }
+
     QString dist = ui->comboBox->currentText();
     QString path1 = ui->leVec1->text();
     QString path2 = ui->leVec2->text();
-    QVector<double> vec1 = MainWindow::parseVector(path1);
-    QVector<double> vec2 = MainWindow::parseVector(path2);
-    if (ui->leRes->text() == "ERROR: The file could not be opened. Please make sure you have selected the correct file with corrected form or entered a valid path."){
+    QVector<double> vec1;
+    QVector<double> vec2;
+    if (!MainWindow::parseVector(path1, vec1) || !MainWindow::parseVector(path2, vec2)){
         return;
     }
     if (vec1.size() != vec2.size()){
@@ -681,12 +1106,13 @@ void MainWindow::pbCompute()
 
 
     if (dist == "Mahalanobis Distance"){
-        int dim = vec1.size();
-
-        // Kreiranje identitetske matrice dim x dim
-        QVector<QVector<double>> identityMatrix(dim, QVector<double>(dim, 0.0));
-        for (int i = 0; i < dim; ++i) {
-            identityMatrix[i][i] = 1.0;
+        if (!_distanceTab->loadReference(ui->leParam->text().trimmed())){
+            ui->leRes->setText("ERROR: " + _distanceTab->getErrorString());
+            return;
+        }
+        if (_distanceTab->getMahalanobis().getDimension() != vec1.size()){
+            ui->leRes->setText("ERROR: The reference dataset and the vectors are not of the same dimensions.");
+            return;
         }
         double res = MainWindow::mahalanobisDistance(vec1, vec2);
         ui->leRes->setText(QString::number(res));
@@ -695,35 +1121,19 @@ void MainWindow::pbCompute()
         double res = MainWindow::cosineDistance(vec1, vec2);
         ui->leRes->setText(QString::number(res));
     }
-    if (dist == "Hamming Distance"){
-        for (int i = 0; i < vec1.size(); ++i) {
-        if (!(vec1[i] == 0 or vec1[i] == 1)){
+    if (dist == "Hamming Distance" || dist == "Jaccard coefficient"){
+        BitVectorSet bits;
+        if (!bits.append(vec1) || !bits.append(vec2)){
             ui->leRes->setText("Vectors value must be 1 or 0");
-                return;
-        }
-        if (!(vec2[i] == 0 or vec2[i] == 1)){
-            ui->leRes->setText("Vectors value must be 1 or 0");
-                return;
-        }
-        }
-        int res = MainWindow::hammingDistance(vec1, vec2);
-        ui->leRes->setText(QString::number(res));
-
-    }
-    if (dist == "Jaccard coefficient"){
-        for (int i = 0; i < vec1.size(); ++i) {
-        if (!(vec1[i] == 0 or vec1[i] == 1)){
-                ui->leRes->setText("Vectors value must be 1 or 0");
-                return;
-        }
-        if (!(vec2[i] == 0 or vec2[i] == 1)){
-                ui->leRes->setText("Vectors value must be 1 or 0");
-                return;
+            return;
         }
+        if (dist == "Hamming Distance"){
+            int res = MainWindow::hammingDistance(bits);
+            ui->leRes->setText(QString::number(res));
+        } else {
+            double res = MainWindow::jaccardCoefficient(bits);
+            ui->leRes->setText(QString::number(res));
         }
-    double res = MainWindow::jaccardCoefficient(vec1, vec2);
-    ui->leRes->setText(QString::number(res));
-
     }
 }
 
@@ -752,4 +1162,5 @@ MainWindow::~MainWindow()
     delete _gridScene;
     delete _frequentItemsetTab;
     delete _frequentItemsetScene;
+    delete _distanceTab;
 }
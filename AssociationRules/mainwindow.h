@@ -6,6 +6,7 @@
 #include <QMessageBox>
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QTableWidget>
 #include <QFile>
 #include <QTextStream>
 #include <QVector>
@@ -18,6 +19,12 @@
 #include <QDebug>
 #include "tabs/Grid/grid.h"
 #include "tabs/FrequentItemset/frequentitemset.h"
+#include "tabs/Distance/distance.h"
+#include "common/transactioncache.h"
+#include "common/samplingminer.h"
+#include "common/rpgrowth.h"
+#include "common/mrgexp.h"
+#include "common/profiler.h"
 
 
 
@@ -49,6 +56,7 @@ public slots:
     void pbChooseVector1();
     void pbChooseVector2();
     void pbCompute();
+    void pbChooseMatrixOutput();
 
     void pbChooseApr();
     void pbFindRare();
@@ -61,18 +69,37 @@ private:
     QGraphicsScene *_gridScene;
     FrequentItemset *_frequentItemsetTab;
     QGraphicsScene *_frequentItemsetScene;
+    Distance *_distanceTab;
+    QString _traceFilePath;
 
     void gridConfig();
     void frequentItemsetConfig();
-    double minkowskiDistance(const QVector<double> &vec1, const QVector<double> &vec2, double p);
+    bool readOptionalParameter(QTableWidget *table, int row, double &value);
+    bool readItemsParameter(QTableWidget *table, int row, QSet<int> &items);
+    void showProfile();
+    static double minkowskiDistance(const QVector<double> &vec1, const QVector<double> &vec2, double p);
     double mahalanobisDistance(const QVector<double> &vec1, const QVector<double> &vec2);
-    double cosineDistance(const QVector<double>& vec1, const QVector<double>& vec2);
-    int hammingDistance(const QVector<double>& vec1, const QVector<double>& vec2);
-    double jaccardCoefficient(const QVector<double> &vec1, const QVector<double> &vec2);
+    static double cosineDistance(const QVector<double>& vec1, const QVector<double>& vec2);
+    static int hammingDistance(const BitVectorSet &vectors);
+    static double jaccardCoefficient(const BitVectorSet &vectors);
 
-    QVector<double> parseVector(const QString& filePath);
+    bool parseVector(const QString& filePath, QVector<double> &vector);
+    void computeDistanceMatrix();
 
     void findRareItemsets(const QString &filename);
+    bool findRareItemsetsBySampling(const QString &filename, double minSupport,
+                                    QMap<QVector<int>,int> &minimalRare, QString &summary);
+    bool findRareItemsetsByRPGrowth(const QString &filename, double minSupport,
+                                    QMap<QVector<int>,int> &rareItemsets, QString &summary,
+                                    QString &header);
+    bool findRareItemsetsByMRGExp(const QString &filename, double minSupport,
+                                  QMap<QVector<int>,int> &minimalRare, QString &summary);
+    static bool findAprioriRare(const QString &filename, double MIN_SUPPORT,
+                                QMap<QVector<int>,int> &minimalRare);
+    static bool loadRareDatabase(const QString &filename, QVector<QVector<int>> &database);
+
+    // arules_bench runs the rare itemset miners and the distance functions without a window.
+    friend class BenchmarkAccess;
 
 
 
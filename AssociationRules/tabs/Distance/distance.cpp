@@ -1,3 +1,273 @@
 #include "distance.h"
 
-Distance::Distance() {}
+Distance::Distance()
+{
+    _referenceSize = -1;
+}
+
+
+QString Distance::getErrorString()
+{
+    return _errorString;
+}
+
+
+QString Distance::getSummary()
+{
+    return _summary;
+}
+
+
+Mahalanobis &Distance::getMahalanobis()
+{
+    return _mahalanobis;
+}
+
+
+bool Distance::loadReference(const QString &referencePath)
+{
+    _errorString.clear();
+
+    QFileInfo fileInfo(referencePath);
+    if(referencePath == _referencePath && fileInfo.lastModified() == _referenceModified
+        && fileInfo.size() == _referenceSize && _mahalanobis.getDimension() > 0) {
+        return true;
+    }
+
+    _referencePath.clear();
+    VectorSet reference;
+    if(!reference.load(referencePath)) {
+        _errorString = reference.getErrorString();
+        return false;
+    }
+    if(!_mahalanobis.fit(reference)) {
+        _errorString = _mahalanobis.getErrorString();
+        return false;
+    }
+
+    _referencePath = referencePath;
+    _referenceModified = fileInfo.lastModified();
+    _referenceSize = fileInfo.size();
+
+    return true;
+}
+
+
+bool Distance::computeMatrix(
+    const DistanceMatrix::Metric metric,
+    const double p,
+    const int threadsCount,
+    const QString &rowsPath,
+    const QString &columnsPath,
+    const QString &outputPath
+)
+{
+    _errorString.clear();
+    _summary.clear();
+
+    bool pairs = columnsPath.isEmpty();
+    QFile file;
+    DistanceMatrix matrix(metric, p, threadsCount);
+    auto writer = [&file, pairs](const int firstRow, const int rowsCount, const int columnsCount, const std::vector<double> &values) {
+        return writeRows(file, firstRow, rowsCount, columnsCount, values, pairs);
+    };
+
+    // Hamming and Jaccard vectors are packed into bits while they are read.
+    auto computeSets = [&](auto &rows, auto &columns, auto prepare, const QString &instructionSet) {
+        if(!rows.load(rowsPath)) {
+            _errorString = rows.getErrorString();
+            return false;
+        }
+        if(!pairs && !columns.load(columnsPath)) {
+            _errorString = columns.getErrorString();
+            return false;
+        }
+        if(!pairs && rows.getDimension() != columns.getDimension()) {
+            _errorString = "Vectors are not of the same dimensions.";
+            return false;
+        }
+        if(!prepare(rows, columns)) {
+            return false;
+        }
+
+        file.setFileName(outputPath);
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            _errorString = "Unable to open " + outputPath;
+            return false;
+        }
+
+        bool success = pairs ? matrix.computePairs(rows, writer) : matrix.compute(rows, columns, writer);
+        if(!success) {
+            _errorString = "Unable to write " + outputPath;
+            return false;
+        }
+
+        qint64 distancesCount = pairs
+            ? static_cast<qint64>(rows.getRowsCount()) * (rows.getRowsCount() - 1) / 2
+            : static_cast<qint64>(rows.getRowsCount()) * columns.getRowsCount();
+        _summary = QString("%1 values written (%2, %3 threads)")
+            .arg(distancesCount)
+            .arg(instructionSet)
+            .arg(matrix.getThreadsCount());
+
+        return true;
+    };
+
+    if(metric == DistanceMatrix::Hamming || metric == DistanceMatrix::Jaccard) {
+        BitVectorSet rows;
+        BitVectorSet columns;
+        auto unchanged = [](BitVectorSet &, BitVectorSet &) {
+            return true;
+        };
+        return computeSets(rows, columns, unchanged, BitVectorSet::getInstructionSet());
+    }
+
+    auto whiten = [&](VectorSet &rows, VectorSet &columns) {
+        return metric != DistanceMatrix::Mahalanobis || whitenSets(rows, columns, !pairs);
+    };
+
+    VectorSet rows;
+    VectorSet columns;
+    return computeSets(rows, columns, whiten, matrix.getInstructionSet());
+}
+
+
+bool Distance::computeNeighbours(
+    const DistanceMatrix::Metric metric,
+    const double p,
+    const int threadsCount,
+    const int k,
+    const double radius,
+    const QString &rowsPath,
+    const QString &columnsPath,
+    const QString &outputPath
+)
+{
+    _errorString.clear();
+    _summary.clear();
+
+    if(metric != DistanceMatrix::Minkowski && metric != DistanceMatrix::Cosine && metric != DistanceMatrix::Mahalanobis) {
+        _errorString = "Nearest neighbours support the Minkowski, Cosine and Mahalanobis distances";
+        return false;
+    }
+    if(metric == DistanceMatrix::Minkowski && p < 1) {
+        _errorString = "Nearest neighbours need p >= 1";
+        return false;
+    }
+
+    // Without a second file every vector is searched among the others.
+    bool self = columnsPath.isEmpty();
+    VectorSet rows;
+    VectorSet columns;
+    if(!rows.load(rowsPath)) {
+        _errorString = rows.getErrorString();
+        return false;
+    }
+    if(!self && !columns.load(columnsPath)) {
+        _errorString = columns.getErrorString();
+        return false;
+    }
+    if(!self && rows.getDimension() != columns.getDimension()) {
+        _errorString = "Vectors are not of the same dimensions.";
+        return false;
+    }
+
+    if(metric == DistanceMatrix::Mahalanobis && !whitenSets(rows, columns, !self)) {
+        return false;
+    }
+
+    bool cosine = metric == DistanceMatrix::Cosine;
+    VpTree tree(metric == DistanceMatrix::Minkowski ? p : 2, cosine, threadsCount);
+    tree.build(self ? rows : columns);
+
+    // For cosine the radius is the minimum similarity.
+    double searchRadius = cosine ? tree.cosineRadius(radius) : radius;
+    QVector<QVector<VpTree::Neighbour>> neighbours = tree.searchAll(rows, k, searchRadius, self);
+
+    QFile file(outputPath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        _errorString = "Unable to open " + outputPath;
+        return false;
+    }
+
+    QByteArray buffer;
+    char line[64];
+    qint64 neighboursCount = 0;
+    for(int row = 0; row < neighbours.size(); row++) {
+        for(const VpTree::Neighbour &neighbour : neighbours[row]) {
+            double value = cosine ? tree.cosineSimilarity(neighbour.distance) : neighbour.distance;
+            int length = std::snprintf(line, sizeof(line), "%d %d %g\n", row, neighbour.index, value);
+            buffer.append(line, length);
+        }
+        neighboursCount += neighbours[row].size();
+
+        if(buffer.size() > (1 << 20) || row == neighbours.size() - 1) {
+            if(file.write(buffer) != buffer.size()) {
+                _errorString = "Unable to write " + outputPath;
+                return false;
+            }
+            buffer.clear();
+        }
+    }
+
+    qint64 pointsCount = self ? rows.getRowsCount() : columns.getRowsCount();
+    _summary = QString("%1 neighbours written, %2 distances per query instead of %3")
+        .arg(neighboursCount)
+        .arg(tree.getDistancesCount() / std::max(1, rows.getRowsCount()))
+        .arg(pointsCount);
+
+    return true;
+}
+
+
+bool Distance::whitenSets(VectorSet &rows, VectorSet &columns, const bool withColumns)
+{
+    // Whitened by the reference factor, Mahalanobis becomes Euclidean.
+    if(rows.getDimension() != _mahalanobis.getDimension()) {
+        _errorString = QString("The reference dataset has %1 values per vector, expected %2")
+            .arg(_mahalanobis.getDimension()).arg(rows.getDimension());
+        return false;
+    }
+
+    VectorSet whitened;
+    _mahalanobis.whiten(rows, whitened);
+    rows = whitened;
+    if(withColumns) {
+        _mahalanobis.whiten(columns, whitened);
+        columns = whitened;
+    }
+
+    return true;
+}
+
+
+bool Distance::writeRows(
+    QFile &file,
+    const int firstRow,
+    const int rowsCount,
+    const int columnsCount,
+    const std::vector<double> &values,
+    const bool pairs
+)
+{
+    QByteArray buffer;
+    char number[32];
+    for(int row = 0; row < rowsCount; row++) {
+        int firstColumn = pairs ? firstRow + row + 1 : 0;
+        if(firstColumn >= columnsCount) {
+            continue;
+        }
+
+        const double *rowValues = values.data() + static_cast<size_t>(row) * columnsCount;
+        for(int column = firstColumn; column < columnsCount; column++) {
+            int length = std::snprintf(number, sizeof(number), "%g", rowValues[column]);
+            if(column > firstColumn) {
+                buffer.append(',');
+            }
+            buffer.append(number, length);
+        }
+        buffer.append('\n');
+    }
+
+    return file.write(buffer) == buffer.size();
+}
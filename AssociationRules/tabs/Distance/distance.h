@@ -1,10 +1,82 @@
 #ifndef DISTANCE_H
 #define DISTANCE_H
 
+#include <QString>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+#include <cstdio>
+
+#include "../../common/vectorset.h"
+#include "../../common/distancematrix.h"
+#include "../../common/mahalanobis.h"
+#include "../../common/vptree.h"
+
+
+// Batch mode of the Distance tab: both files hold one vector per line and
+// every row vector is compared with every column vector. Without a column
+// file the vectors of the row file are compared pairwise, only i < j is
+// computed and line i of the output holds the values for j = i + 1 .. n - 1.
+//
+// Mahalanobis distances use the covariance of a reference dataset. Its
+// Cholesky factor is kept between computations and only rebuilt when another
+// file is chosen or the file changes.
+//
+// Instead of the full matrix, computeNeighbours() writes the k nearest
+// neighbours and/or all neighbours within a radius of every row vector, one
+// "i j value" line each, using a VP-tree over the column vectors.
 class Distance
 {
 public:
+    // Constructors
     Distance();
+
+    // Getters
+    QString getErrorString();
+    QString getSummary();
+    Mahalanobis &getMahalanobis();
+
+    // Functions
+    bool loadReference(const QString &referencePath);
+    bool computeMatrix(
+        const DistanceMatrix::Metric metric,
+        const double p,
+        const int threadsCount,
+        const QString &rowsPath,
+        const QString &columnsPath,
+        const QString &outputPath
+    );
+    bool computeNeighbours(
+        const DistanceMatrix::Metric metric,
+        const double p,
+        const int threadsCount,
+        const int k,
+        const double radius,
+        const QString &rowsPath,
+        const QString &columnsPath,
+        const QString &outputPath
+    );
+
+private:
+    // Fields
+    QString _errorString;
+    QString _summary;
+    Mahalanobis _mahalanobis;
+    QString _referencePath;
+    QDateTime _referenceModified;
+    qint64 _referenceSize;
+
+    // Functions
+    bool whitenSets(VectorSet &rows, VectorSet &columns, const bool withColumns);
+    static bool writeRows(
+        QFile &file,
+        const int firstRow,
+        const int rowsCount,
+        const int columnsCount,
+        const std::vector<double> &values,
+        const bool pairs
+    );
 };
 
 #endif // DISTANCE_H
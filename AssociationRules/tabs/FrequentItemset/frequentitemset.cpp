@@ -12,6 +12,9 @@ FrequentItemset::FrequentItemset()
     _outputFilePath = absoluteRootPath + "/AssociationRules/resources/Frequent Itemset/output.txt";
 
     _nodeRadius = 25;
+    _topK = 0;
+    _threadsCount = 0;
+    _stepIndex = 0;
 
     _editor = new QTextEdit(nullptr);
     _editor->setReadOnly(true);
@@ -38,6 +41,24 @@ QString FrequentItemset::getOutputFilePath()
 }
 
 
+void FrequentItemset::setTopK(const int topK)
+{
+    _topK = topK;
+}
+
+
+void FrequentItemset::setItemConstraints(const ItemConstraints &constraints)
+{
+    _constraints = constraints;
+}
+
+
+void FrequentItemset::setThreadsCount(const int threadsCount)
+{
+    _threadsCount = threadsCount;
+}
+
+
 QString FrequentItemset::onBrowseButtonClicked()
 {
     QString filePath = QFileDialog::getOpenFileName(
@@ -82,193 +103,124 @@ void FrequentItemset::onRunAlgorithmButtonClicked(QGraphicsScene *scene, const d
     _transactions.clear();
     _sortedTransactions.clear();
     _itemsFrequencies.clear();
-    _setsFrequencies.clear();
-    _childrenMap.clear();
-    _pendingRemovalEllipses.clear();
     _frequentItemsets.clear();
-    _nodesSupport.clear();
-    _nodePositions.clear();
+    _treeNodes.clear();
+    _itemsNodes.clear();
+    _stepItems.clear();
+    _stepIndex = 0;
     _removalColoring = true;
 
     bool readFileSuccess = readFile();
     if(!readFileSuccess) {
         return;
     }
+    PROFILE_COUNT("transactions scanned", _transactions.size());
 
+    removeExcludedItems();
     findItemFrequencies();
     sortTransactions();
-    findSetsFrequencies();
 
     _minSupport = minSupport * _sortedTransactions.size();
+    if(_topK > 0) {
+        PROFILE_SCOPE("top-k");
+
+        // The top-k itemsets are the result, and the support of the k-th one
+        // becomes the threshold of the tree, so Forward steps find them again.
+        TopKMiner miner(_transactions);
+        QMap<QVector<int>, int> topKItemsets = miner.mineFrequent(_topK);
+        _minSupport = miner.getMinCount();
+        for(auto it = topKItemsets.cbegin(); it != topKItemsets.cend(); it++) {
+            if(_constraints.isSatisfied(it.key())) {
+                _frequentItemsets[it.key()] = it.value();
+            }
+        }
+    }
 
     removeRareItemsets();
-    findChildren();
-
-    _currentChildrenMap = _childrenMap;
+    buildTree();
 
     drawTree(scene);
+
+    if(_threadsCount > 0) {
+        if(_topK == 0) {
+            mineParallel();
+        }
+        saveFile(sortFrequentItemsets());
+    }
 }
 
 
 void FrequentItemset::onForwardButtonClicked(QGraphicsScene *scene)
 {
-    if(_childrenMap.size() == 0) {
+    if(_treeNodes.isEmpty()) {
         QMessageBox::critical(nullptr, "Error", "Run the algorithm first");
         return;
     }
 
-    if(_currentChildrenMap.size() == 0) {
-        QVector<QVector<int>> frequentItemsetVector = _frequentItemsets.keys();
-        std::sort(frequentItemsetVector.begin(), frequentItemsetVector.end(),
-            [](const QVector<int> &a, const QVector<int> &b) {
-                if(a.size() == b.size()) {
-                    return a < b;
-                }
-
-                return a.size() < b.size();
-            }
-        );
-
-        saveFile(frequentItemsetVector);
+    if(_stepIndex == _stepItems.size()) {
+        saveFile(sortFrequentItemsets());
 
         return;
     }
 
-    int maxDepth = 0;
-    for(auto it = _currentChildrenMap.cbegin(); it != _currentChildrenMap.cend(); it++) {
-        int keySize = it.key().size();
-        maxDepth = std::max(maxDepth, keySize);
-    }
+    PROFILE_SCOPE("mine");
 
-    QVector<QVector<int>> deepestNodes;
-    for(auto it = _currentChildrenMap.cbegin(); it != _currentChildrenMap.cend(); it++) {
-        if(it.key().size() == maxDepth) {
-            deepestNodes.append(it.key());
-        }
-    }
-
-    QVector<int> nodeToRemove;
-    int minFrequency = INT_MAX;
-    for(auto it = deepestNodes.cbegin(); it != deepestNodes.cend(); it++) {
-        int frequency = _itemsFrequencies.value(it->last(), INT_MAX);
-        if(frequency < minFrequency) {
-            minFrequency = frequency;
-            nodeToRemove = *it;
-        }
-    }
+    // Items are taken from the least frequent one up, so by the time an item
+    // is reached all of its nodes are leaves.
+    int lastElement = _stepItems[_stepIndex];
+    const QVector<int> &nodesToRemove = _itemsNodes[lastElement];
 
-    QVector<QVector<int>> nodesToRemove;
-    for(auto it = _currentChildrenMap.cbegin(); it != _currentChildrenMap.cend(); it++) {
-        if(it.key().last() == nodeToRemove.last() && it.value().isEmpty()) {
-            nodesToRemove.append(it.key());
+    if(_removalColoring) {
+        QString message = "Conditional pattern base of " + QString::number(lastElement) + ":\n";
+        QVector<QPair<QVector<int>, int>> base;
+        int suffixSupport = 0;
+        for(int node : nodesToRemove) {
+            suffixSupport += _treeNodes[node].support;
+
+            QVector<int> prefix = nodePath(_treeNodes[node].parent);
+            if(!prefix.isEmpty()) {
+                base.append(qMakePair(prefix, _treeNodes[node].support));
+                message += itemsetText(prefix) + "  : " + QString::number(_treeNodes[node].support) + "\n";
+            }
         }
-    }
 
-    QString message = "Paths:\n";
-    QMap<QVector<int>, int> paths;
-    for(QVector<int> &node : nodesToRemove) {
-        paths[node] = _nodesSupport[node];
-
-        for(int i : node) {
-            message += QString::number(i);
-        }
-        message += "\n";
-    }
-
-    QVector<QVector<int>> candidates;
-    int lastElement = nodeToRemove.last();
-    QVector<QVector<int>> nodesToRemoveCopy = nodesToRemove;
-    message += "\nCandidates:\n";
-    for(int i = 0; i < nodesToRemoveCopy.size(); i++) {
-        nodesToRemoveCopy[i].pop_back();
-
-        int nodeSize = nodesToRemoveCopy[i].size();
-        int numCombinations = pow(2, nodeSize);
-        for(int j = 0; j < numCombinations; j++) {
-            QVector<int> combination;
-            for(int k = 0; k < nodeSize; k++) {
-                if(j & (1 << k)) {
-                    combination.push_back(nodesToRemoveCopy[i][k]);
+        QVector<QPair<QVector<int>, int>> found;
+        bool suffixAllowed = _constraints.getRequiredItems().isEmpty() || _constraints.isRequired(lastElement);
+        if(suffixAllowed) {
+            message += "\nConditional FP-tree:\n";
+            QMap<int, int> counts = baseCounts(base);
+            QVector<int> treeItems;
+            for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+                if(isFrequent(it.value())) {
+                    treeItems.append(it.key());
                 }
             }
-
-            combination.push_back(lastElement);
-
-            auto foundIt = std::find(candidates.begin(), candidates.end(), combination);
-            if(foundIt == candidates.end()) {
-                candidates.push_back(combination);
-                QVector<int> sortedCombination = combination;
-                std::sort(sortedCombination.begin(), sortedCombination.end());
-                message += "{";
-                for(int i : combination) {
-                    message += QString::number(i) + ", ";
+            std::sort(treeItems.begin(), treeItems.end(),
+                [this](const int a, const int b) {
+                    return itemPrecedes(a, b);
                 }
-                message = message.removeLast().removeLast() + "}  #SUP: " + QString::number(_setsFrequencies[sortedCombination]) + "\n";
+            );
+            for(int item : treeItems) {
+                message += QString::number(item) + ": " + QString::number(counts.value(item)) + "\n";
             }
-        }
-    }
 
-    message += "\nFrequent itemsets:\n";
-    for(QVector<int> &set : candidates) {
-        QVector<int> sortedSet = set;
-        std::sort(sortedSet.begin(), sortedSet.end());
-        auto foundIt = _frequentItemsets.find(sortedSet);
-        if((_minSupport - _setsFrequencies[sortedSet] < 0.001) && foundIt == _frequentItemsets.end()) {
-            message += "{";
-            for(int i : set) {
-                message += QString::number(i) + ", ";
-            }
-            message = message.removeLast().removeLast() + "}  #SUP: " + QString::number(_setsFrequencies[sortedSet]) + "\n";
-            _frequentItemsets[sortedSet] = _setsFrequencies[sortedSet];
+            found.append(qMakePair(QVector<int>{lastElement}, suffixSupport));
+            mineConditionalBase(base, QVector<int>{lastElement}, found);
+        } else {
+            message += "\nNone, " + QString::number(lastElement) + " is not a required item\n";
         }
-    }
 
-    if(_removalColoring) {
-        for(const auto &node : nodesToRemove) {
-            QPointF pos = _nodePositions[node];
-            QGraphicsEllipseItem *nodeToRemove = nullptr;
-            QGraphicsTextItem *textToRemove = nullptr;
-            QList<QGraphicsItem*> itemsInArea = scene->items(
-                QRectF(
-                    pos.x() - _nodeRadius, pos.y() - _nodeRadius,
-                    _nodeRadius * 2, _nodeRadius * 2
-                )
-            );
+        message += "\nFrequent itemsets:\n";
+        for(const auto &pair : found) {
+            message += itemsetText(pair.first) + "  #SUP: " + QString::number(pair.second) + "\n";
 
-            for(QGraphicsItem *item : itemsInArea) {
-                if(auto ellipse = dynamic_cast<QGraphicsEllipseItem*>(item)) {
-                    nodeToRemove = ellipse;
-                } else if(auto text = dynamic_cast<QGraphicsTextItem*>(item)) {
-                    textToRemove = text;
-                }
-            }
-
-            if(nodeToRemove) {
-                scene->removeItem(nodeToRemove);
-                delete nodeToRemove;
-            }
-
-            if(textToRemove) {
-                scene->removeItem(textToRemove);
-                delete textToRemove;
-            }
+            QVector<int> sortedSet = pair.first;
+            std::sort(sortedSet.begin(), sortedSet.end());
+            _frequentItemsets[sortedSet] = pair.second;
+        }
 
-            QGraphicsEllipseItem *ellipse = scene->addEllipse(
-                pos.x() - _nodeRadius, pos.y() - _nodeRadius,
-                _nodeRadius * 2, _nodeRadius * 2,
-                QPen(Qt::black), QBrush(Qt::red)
-            );
-            QString nodeText = QString::number(node.last()) + ": " + QString::number(_nodesSupport[node]);
-            QGraphicsTextItem *text = scene->addText(nodeText);
-            QFont font = text->font();
-            font.setPointSize(7);
-            text->setFont(font);
-            text->setPos(
-                pos.x() - text->boundingRect().width() / 2,
-                pos.y() - text->boundingRect().height() / 2
-            );
-            text->setDefaultTextColor(Qt::black);
-            _pendingRemovalEllipses.append(ellipse);
+        for(int node : nodesToRemove) {
+            _treeNodes[node].ellipse->setBrush(QBrush(Qt::red));
         }
 
         _editor->setText(message);
@@ -276,40 +228,22 @@ void FrequentItemset::onForwardButtonClicked(QGraphicsScene *scene)
 
         _removalColoring = false;
     } else {
-        for(const auto &node : nodesToRemove) {
-            for(auto &parent : _currentChildrenMap.keys()) {
-                if(_currentChildrenMap[parent].contains(node)) {
-                    _currentChildrenMap[parent].removeOne(node);
-                    break;
-                }
-            }
-            _currentChildrenMap.remove(node);
+        for(int node : nodesToRemove) {
+            TreeNode &treeNode = _treeNodes[node];
+            scene->removeItem(treeNode.ellipse);
+            scene->removeItem(treeNode.text);
+            scene->removeItem(treeNode.edge);
+            delete treeNode.ellipse;
+            delete treeNode.text;
+            delete treeNode.edge;
+            treeNode.ellipse = nullptr;
+            treeNode.text = nullptr;
+            treeNode.edge = nullptr;
+
+            _treeNodes[treeNode.parent].children.removeOne(node);
         }
 
-        for(auto &ellipse : _pendingRemovalEllipses) {
-            QList<QGraphicsItem*> items = scene->items(
-                QRectF(
-                    ellipse->rect().center().x() - _nodeRadius,
-                    ellipse->rect().center().y() - _nodeRadius,
-                    _nodeRadius * 2, _nodeRadius * 2
-                )
-            );
-
-            for(QGraphicsItem *item : items) {
-                if(auto *line = dynamic_cast<QGraphicsLineItem*>(item)) {
-                    scene->removeItem(line);
-                    delete line;
-                } else if(auto *text = dynamic_cast<QGraphicsTextItem*>(item)) {
-                    scene->removeItem(text);
-                    delete text;
-                }
-            }
-
-            scene->removeItem(ellipse);
-            delete ellipse;
-        }
-
-        _pendingRemovalEllipses.clear();
+        _stepIndex++;
         _removalColoring = true;
     }
 }
@@ -317,11 +251,20 @@ void FrequentItemset::onForwardButtonClicked(QGraphicsScene *scene)
 
 bool FrequentItemset::readFile()
 {
+    PROFILE_SCOPE("read");
+
+    TransactionCache cache(_inputFilePath);
+    if(cache.load(_transactions)) {
+        _itemsFrequencies = cache.getItemFrequencies();
+        return true;
+    }
+
     QFile file(_inputFilePath);
     if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QMessageBox::critical(nullptr, "Error", "Unable to open the input file");
         return false;
     }
+    PROFILE_COUNT("bytes parsed", file.size());
 
     QTextStream in(&file);
     while(!in.atEnd()) {
@@ -352,12 +295,34 @@ bool FrequentItemset::readFile()
 
     file.close();
 
+    if(cache.save(_transactions)) {
+        _itemsFrequencies = cache.getItemFrequencies();
+    }
+
     return true;
 }
 
 
+void FrequentItemset::removeExcludedItems()
+{
+    for(int item : _constraints.getExcludedItems()) {
+        _itemsFrequencies.remove(item);
+    }
+
+    for(QVector<int> &transaction : _transactions) {
+        transaction = _constraints.removeExcluded(transaction);
+    }
+}
+
+
 void FrequentItemset::findItemFrequencies()
 {
+    PROFILE_SCOPE("count");
+
+    if(!_itemsFrequencies.isEmpty()) {
+        return;
+    }
+
     for(const QVector<int> &transaction : _transactions) {
         for(int item : transaction) {
             _itemsFrequencies[item]++;
@@ -366,55 +331,46 @@ void FrequentItemset::findItemFrequencies()
 }
 
 
-void FrequentItemset::sortTransactions()
+bool FrequentItemset::itemPrecedes(const int a, const int b)
 {
-    _sortedTransactions = _transactions;
-    for(QVector<int> &transaction : _sortedTransactions) {
-        std::sort(transaction.begin(), transaction.end(),
-            [this](int a, int b) {
-                return _itemsFrequencies.value(a, 0) > _itemsFrequencies.value(b, 0);
-            }
-        );
+    // Required items end every path, so only their conditional bases can hold
+    // itemsets satisfying the constraint. Ties are broken by the item so that
+    // all paths share one order.
+    bool requiredA = _constraints.isRequired(a);
+    bool requiredB = _constraints.isRequired(b);
+    if(requiredA != requiredB) {
+        return requiredB;
     }
-}
 
+    int frequencyA = _itemsFrequencies.value(a, 0);
+    int frequencyB = _itemsFrequencies.value(b, 0);
+    if(frequencyA != frequencyB) {
+        return frequencyA > frequencyB;
+    }
 
-void FrequentItemset::findSetsFrequencies()
-{
-    QVector<int> items = _itemsFrequencies.keys();
-    int numItems = items.size();
-    int totalCombinations = pow(2, numItems);
+    return a < b;
+}
 
-    for(int mask = 1; mask < totalCombinations; mask++) {
-        QVector<int> combination;
 
-        for(int i = 0; i < numItems; i++) {
-            if(mask & (1 << i)) {
-                combination.append(items[i]);
-            }
-        }
-
-        int count = 0;
-        for(const QVector<int> &transaction : _transactions) {
-            bool isSubset = std::all_of(
-                combination.begin(), combination.end(),
-                [&transaction](int item) {
-                    return transaction.contains(item);
-                }
-            );
+void FrequentItemset::sortTransactions()
+{
+    PROFILE_SCOPE("sort");
 
-            if(isSubset) {
-                count++;
+    _sortedTransactions = _transactions;
+    for(QVector<int> &transaction : _sortedTransactions) {
+        std::sort(transaction.begin(), transaction.end(),
+            [this](int a, int b) {
+                return itemPrecedes(a, b);
             }
-        }
-
-        _setsFrequencies[combination] = count;
+        );
     }
 }
 
 
 void FrequentItemset::removeRareItemsets()
 {
+    PROFILE_SCOPE("prune");
+
     for(QVector<int> &transaction : _sortedTransactions) {
         auto it = transaction.begin();
         while(it != transaction.end()) {
@@ -428,190 +384,386 @@ void FrequentItemset::removeRareItemsets()
 }
 
 
-void FrequentItemset::findChildren()
+void FrequentItemset::buildTree()
 {
+    PROFILE_SCOPE("build tree");
+
+    _treeNodes.append(TreeNode{-1, 0, -1, {}, QPointF(), nullptr, nullptr, nullptr, 0, 0, 0, 0, -1, 0, 0});
+
     for(QVector<int> &transaction : _sortedTransactions) {
-        QVector<int> current;
+        int node = 0;
+        _treeNodes[node].support++;
 
         for(int item : transaction) {
-            current.push_back(item);
+            int child = -1;
+            for(int candidate : _treeNodes[node].children) {
+                if(_treeNodes[candidate].item == item) {
+                    child = candidate;
+                    break;
+                }
+            }
 
-            if(_childrenMap.find(current) == _childrenMap.end()) {
-                _childrenMap[current] = {};
+            if(child < 0) {
+                child = _treeNodes.size();
+                int number = _treeNodes[node].children.size();
+                _treeNodes.append(TreeNode{item, 0, node, {}, QPointF(), nullptr, nullptr, nullptr, 0, 0, 0, 0, -1, child, number});
+                _treeNodes[node].children.append(child);
+                _itemsNodes[item].append(child);
             }
 
-            if(current.size() < transaction.size()) {
-                QVector<int> child = current;
-                child.push_back(transaction[current.size()]);
+            node = child;
+            _treeNodes[node].support++;
+        }
+    }
 
-                if(!childExists(_childrenMap[current], child)) {
-                    _childrenMap[current].push_back(child);
-                }
-            }
+    // Forward steps go from the last item of the path order to the first.
+    _stepItems = _itemsNodes.keys().toVector();
+    std::sort(_stepItems.begin(), _stepItems.end(),
+        [this](const int a, const int b) {
+            return itemPrecedes(b, a);
         }
+    );
+    PROFILE_COUNT("tree nodes", _treeNodes.size());
+}
+
+
+QVector<int> FrequentItemset::nodePath(const int node)
+{
+    QVector<int> path;
+    for(int current = node; current > 0; current = _treeNodes[current].parent) {
+        path.prepend(_treeNodes[current].item);
     }
+
+    return path;
 }
 
 
-bool FrequentItemset::childExists(const QVector<QVector<int>> &childrenList, const QVector<int> &child)
+bool FrequentItemset::isFrequent(const int support)
 {
-    for(auto &existingChild : childrenList) {
-        if(existingChild == child) {
-            return true;
+    return _minSupport - support < 0.001;
+}
+
+
+QMap<int, int> FrequentItemset::baseCounts(const QVector<QPair<QVector<int>, int>> &base)
+{
+    QMap<int, int> counts;
+    for(const auto &pair : base) {
+        for(int item : pair.first) {
+            counts[item] += pair.second;
         }
     }
 
-    return false;
+    return counts;
 }
 
 
-void FrequentItemset::drawTree(QGraphicsScene *scene)
+void FrequentItemset::mineConditionalBase(
+    const QVector<QPair<QVector<int>, int>> &base,
+    const QVector<int> &suffix,
+    QVector<QPair<QVector<int>, int>> &found
+)
 {
-    QMap<int, int> widths;
-    for(auto it = _childrenMap.begin(); it != _childrenMap.end(); it++) {
-        QVector<int> node = it.key();
-        int keySize = node.size();
-        widths[keySize]++;
-        _nodesSupport[node] = 0;
+    // Prefix paths keep the tree order, so the part of each path before an
+    // item is that item's conditional pattern base.
+    QMap<int, int> counts = baseCounts(base);
+    for(auto it = counts.cbegin(); it != counts.cend(); it++) {
+        if(!isFrequent(it.value())) {
+            continue;
+        }
 
-        for(const QVector<int> &child : it.value()) {
-            bool existsInKeys = false;
-            int valueSize = child.size();
+        QVector<int> itemset = suffix;
+        itemset.prepend(it.key());
+        found.append(qMakePair(itemset, it.value()));
 
-            for(auto keyIt = _childrenMap.begin(); keyIt != _childrenMap.end(); keyIt++) {
-                if(keyIt.key() == child) {
-                    existsInKeys = true;
-                    break;
-                }
+        QVector<QPair<QVector<int>, int>> conditionalBase;
+        for(const auto &pair : base) {
+            int position = pair.first.indexOf(it.key());
+            if(position > 0) {
+                conditionalBase.append(qMakePair(pair.first.mid(0, position), pair.second));
             }
+        }
 
-            if(!existsInKeys) {
-                widths[valueSize]++;
-                _nodesSupport[child] = 0;
-            }
+        if(!conditionalBase.isEmpty()) {
+            mineConditionalBase(conditionalBase, itemset, found);
         }
     }
+}
 
-    int maxWidth = 0;
-    for(auto it = widths.begin(); it != widths.end(); it++) {
-        maxWidth = std::max(maxWidth, it.value());
+
+QString FrequentItemset::itemsetText(const QVector<int> &itemset)
+{
+    QStringList items;
+    for(int item : itemset) {
+        items.append(QString::number(item));
     }
 
-    for(QVector<int> &transaction : _sortedTransactions) {
-        QVector<int> current;
-        for(int item : transaction) {
-            current.push_back(item);
-            _nodesSupport[current]++;
-        }
+    return "{" + items.join(", ") + "}";
+}
+
+
+void FrequentItemset::layoutTree()
+{
+    TRACE_SCOPE("layout");
+
+    // Buchheim, Juenger and Leipert's linear version of Walker's tidy tree
+    // algorithm: subtrees are placed as close as possible without overlap,
+    // parents centered above their children, siblings kept in order.
+    for(TreeNode &node : _treeNodes) {
+        node.prelim = 0;
+        node.modifier = 0;
+        node.shift = 0;
+        node.change = 0;
+        node.thread = -1;
+    }
+    for(int node = 0; node < _treeNodes.size(); node++) {
+        _treeNodes[node].ancestor = node;
     }
 
-    maxWidth *= 100;
-    int levelHeight = 130;
-    int currentY = 0;
+    firstWalk(0);
+    secondWalk(0, -_treeNodes[0].prelim, 0);
+}
 
-    QPointF rootPos(maxWidth / 2.0, currentY);
-    scene->addEllipse(
-        rootPos.x() - _nodeRadius, rootPos.y() - _nodeRadius,
-        _nodeRadius * 2, _nodeRadius * 2,
-        QPen(Qt::black), QBrush(Qt::white)
-    );
-    QGraphicsTextItem *rootText = scene->addText("null");
-    QFont font = rootText->font();
-    font.setPointSize(7);
-    rootText->setFont(font);
-    rootText->setPos(
-        rootPos.x() - rootText->boundingRect().width() / 2,
-        rootPos.y() - rootText->boundingRect().height() / 2
-    );
-    rootText->setDefaultTextColor(Qt::black);
 
-    currentY += levelHeight;
+void FrequentItemset::firstWalk(const int node)
+{
+    const double distance = 4 * _nodeRadius;
+    int sibling = leftSibling(node);
 
-    for(auto it = widths.begin(); it != widths.end(); it++) {
-        int level = it.key();
-        int nodeCount = it.value();
+    if(_treeNodes[node].children.isEmpty()) {
+        _treeNodes[node].prelim = sibling >= 0 ? _treeNodes[sibling].prelim + distance : 0;
+        return;
+    }
 
-        QVector<QPointF> positions;
+    int defaultAncestor = _treeNodes[node].children.first();
+    for(int child : _treeNodes[node].children) {
+        firstWalk(child);
+        defaultAncestor = apportion(child, defaultAncestor);
+    }
+    executeShifts(node);
 
-        for(int i = 0; i < nodeCount; i++) {
-            double xPosition = (maxWidth / static_cast<double>(nodeCount)) * (i + 0.5);
-            positions.append(QPointF(xPosition, currentY));
-        }
+    double midpoint = (_treeNodes[_treeNodes[node].children.first()].prelim
+        + _treeNodes[_treeNodes[node].children.last()].prelim) / 2;
+    if(sibling >= 0) {
+        _treeNodes[node].prelim = _treeNodes[sibling].prelim + distance;
+        _treeNodes[node].modifier = _treeNodes[node].prelim - midpoint;
+    } else {
+        _treeNodes[node].prelim = midpoint;
+    }
+}
 
-        int index = 0;
-        for(auto it = _childrenMap.begin(); it != _childrenMap.end(); it++) {
-            const QVector<int> &childKey = it.key();
-            if(childKey.size() == level) {
-                _nodePositions[childKey] = positions[index++];
-                if(index >= positions.size()) {
-                    break;
-                }
-            }
-        }
 
-        for(auto it = _childrenMap.begin(); it != _childrenMap.end(); it++) {
-            const QVector<int> &childKey = it.key();
-            if(childKey.size() == level) {
-                QPointF pos = _nodePositions[childKey];
-                scene->addEllipse(
-                    pos.x() - _nodeRadius, pos.y() - _nodeRadius,
-                    _nodeRadius * 2, _nodeRadius * 2,
-                    QPen(Qt::black), QBrush(Qt::white)
-                );
-
-                QString nodeText = QString::number(childKey.last()) + ": " + QString::number(_nodesSupport[childKey]);
-                QGraphicsTextItem *text = scene->addText(nodeText);
-                QFont font = text->font();
-                font.setPointSize(7);
-                text->setFont(font);
-                text->setPos(
-                    pos.x() - text->boundingRect().width() / 2,
-                    pos.y() - text->boundingRect().height() / 2
-                );
-                text->setDefaultTextColor(Qt::black);
+int FrequentItemset::apportion(const int node, int defaultAncestor)
+{
+    const double distance = 4 * _nodeRadius;
+    int sibling = leftSibling(node);
+    if(sibling < 0) {
+        return defaultAncestor;
+    }
+
+    // Contours of the subtree (inner/outer right) and of its left siblings
+    // (inner/outer left) are followed level by level through the threads.
+    int innerRight = node;
+    int outerRight = node;
+    int innerLeft = sibling;
+    int outerLeft = _treeNodes[_treeNodes[node].parent].children.first();
+    double innerRightSum = _treeNodes[innerRight].modifier;
+    double outerRightSum = _treeNodes[outerRight].modifier;
+    double innerLeftSum = _treeNodes[innerLeft].modifier;
+    double outerLeftSum = _treeNodes[outerLeft].modifier;
+
+    while(nextRight(innerLeft) >= 0 && nextLeft(innerRight) >= 0) {
+        innerLeft = nextRight(innerLeft);
+        innerRight = nextLeft(innerRight);
+        outerLeft = nextLeft(outerLeft);
+        outerRight = nextRight(outerRight);
+        _treeNodes[outerRight].ancestor = node;
+
+        double shift = (_treeNodes[innerLeft].prelim + innerLeftSum)
+            - (_treeNodes[innerRight].prelim + innerRightSum) + distance;
+        if(shift > 0) {
+            int ancestor = _treeNodes[innerLeft].ancestor;
+            if(_treeNodes[ancestor].parent != _treeNodes[node].parent) {
+                ancestor = defaultAncestor;
             }
+
+            moveSubtree(ancestor, node, shift);
+            innerRightSum += shift;
+            outerRightSum += shift;
         }
 
-        currentY += levelHeight;
+        innerLeftSum += _treeNodes[innerLeft].modifier;
+        innerRightSum += _treeNodes[innerRight].modifier;
+        outerLeftSum += _treeNodes[outerLeft].modifier;
+        outerRightSum += _treeNodes[outerRight].modifier;
     }
 
-    for(auto it = _childrenMap.begin(); it != _childrenMap.end(); it++) {
-        const QVector<int> &childKey = it.key();
-        if(childKey.size() == 1) {
-            QPointF childPos = _nodePositions[childKey];
-            scene->addLine(
-                rootPos.x(), rootPos.y() + _nodeRadius,
-                childPos.x(), childPos.y() - _nodeRadius,
-                QPen(Qt::white)
-            );
+    if(nextRight(innerLeft) >= 0 && nextRight(outerRight) < 0) {
+        _treeNodes[outerRight].thread = nextRight(innerLeft);
+        _treeNodes[outerRight].modifier += innerLeftSum - outerRightSum;
+    }
+
+    if(nextLeft(innerRight) >= 0 && nextLeft(outerLeft) < 0) {
+        _treeNodes[outerLeft].thread = nextLeft(innerRight);
+        _treeNodes[outerLeft].modifier += innerRightSum - outerLeftSum;
+        defaultAncestor = node;
+    }
+
+    return defaultAncestor;
+}
+
+
+void FrequentItemset::moveSubtree(const int left, const int right, const double shift)
+{
+    // The shift is spread over the subtrees in between by executeShifts().
+    int subtrees = _treeNodes[right].number - _treeNodes[left].number;
+    _treeNodes[right].change -= shift / subtrees;
+    _treeNodes[right].shift += shift;
+    _treeNodes[left].change += shift / subtrees;
+    _treeNodes[right].prelim += shift;
+    _treeNodes[right].modifier += shift;
+}
+
+
+void FrequentItemset::executeShifts(const int node)
+{
+    double shift = 0;
+    double change = 0;
+    const QVector<int> &children = _treeNodes[node].children;
+    for(int i = children.size() - 1; i >= 0; i--) {
+        TreeNode &child = _treeNodes[children[i]];
+        child.prelim += shift;
+        child.modifier += shift;
+        change += child.change;
+        shift += child.shift + change;
+    }
+}
+
+
+void FrequentItemset::secondWalk(const int node, const double modifier, const int depth)
+{
+    const int levelHeight = 130;
+    _treeNodes[node].position = QPointF(_treeNodes[node].prelim + modifier, depth * levelHeight);
+
+    for(int child : _treeNodes[node].children) {
+        secondWalk(child, modifier + _treeNodes[node].modifier, depth + 1);
+    }
+}
+
+
+int FrequentItemset::nextLeft(const int node)
+{
+    if(!_treeNodes[node].children.isEmpty()) {
+        return _treeNodes[node].children.first();
+    }
+
+    return _treeNodes[node].thread;
+}
+
+
+int FrequentItemset::nextRight(const int node)
+{
+    if(!_treeNodes[node].children.isEmpty()) {
+        return _treeNodes[node].children.last();
+    }
+
+    return _treeNodes[node].thread;
+}
+
+
+int FrequentItemset::leftSibling(const int node)
+{
+    if(_treeNodes[node].number == 0) {
+        return -1;
+    }
+
+    return _treeNodes[_treeNodes[node].parent].children[_treeNodes[node].number - 1];
+}
+
+
+void FrequentItemset::drawTree(QGraphicsScene *scene)
+{
+    PROFILE_SCOPE("draw");
+
+    layoutTree();
+
+    for(int node = 0; node < _treeNodes.size(); node++) {
+        QPointF pos = _treeNodes[node].position;
+        _treeNodes[node].ellipse = scene->addEllipse(
+            pos.x() - _nodeRadius, pos.y() - _nodeRadius,
+            _nodeRadius * 2, _nodeRadius * 2,
+            QPen(Qt::black), QBrush(Qt::white)
+        );
+
+        QString nodeText = "null";
+        if(node > 0) {
+            nodeText = QString::number(_treeNodes[node].item) + ": " + QString::number(_treeNodes[node].support);
         }
+        QGraphicsTextItem *text = scene->addText(nodeText);
+        QFont font = text->font();
+        font.setPointSize(7);
+        text->setFont(font);
+        text->setPos(
+            pos.x() - text->boundingRect().width() / 2,
+            pos.y() - text->boundingRect().height() / 2
+        );
+        text->setDefaultTextColor(Qt::black);
+        _treeNodes[node].text = text;
     }
 
-    for(auto it = _childrenMap.begin(); it != _childrenMap.end(); it++) {
-        const QVector<int> &parent = it.key();
-        const QVector<QVector<int>> &children = it.value();
+    for(int node = 1; node < _treeNodes.size(); node++) {
+        QPointF parentPos = _treeNodes[_treeNodes[node].parent].position;
+        QPointF childPos = _treeNodes[node].position;
+        _treeNodes[node].edge = scene->addLine(
+            parentPos.x(), parentPos.y() + _nodeRadius,
+            childPos.x(), childPos.y() - _nodeRadius,
+            QPen(Qt::white)
+        );
+    }
+}
 
-        if(!_nodePositions.contains(parent)) {
-            continue;
+
+void FrequentItemset::mineParallel()
+{
+    PROFILE_SCOPE("mine");
+
+    // Same suffix items as the Forward steps, mined all at once.
+    QVector<int> suffixItems;
+    for(int item : _stepItems) {
+        if(_constraints.getRequiredItems().isEmpty() || _constraints.isRequired(item)) {
+            suffixItems.append(item);
         }
+    }
 
-        QPointF parentPos = _nodePositions[parent];
-        for(const QVector<int> &child : children) {
-            if(_nodePositions.contains(child)) {
-                QPointF childPos = _nodePositions[child];
-                scene->addLine(
-                    parentPos.x(), parentPos.y() + _nodeRadius,
-                    childPos.x(), childPos.y() - _nodeRadius,
-                    QPen(Qt::white)
-                );
+    QVector<int> itemsOrder = _stepItems;
+    std::reverse(itemsOrder.begin(), itemsOrder.end());
+
+    ParallelFPGrowth miner(itemsOrder, _threadsCount);
+    _frequentItemsets = miner.mine(_sortedTransactions, static_cast<int>(std::ceil(_minSupport - 0.001)), suffixItems);
+}
+
+
+QVector<QVector<int>> FrequentItemset::sortFrequentItemsets()
+{
+    QVector<QVector<int>> frequentItemsetVector = _frequentItemsets.keys();
+    std::sort(frequentItemsetVector.begin(), frequentItemsetVector.end(),
+        [](const QVector<int> &a, const QVector<int> &b) {
+            if(a.size() == b.size()) {
+                return a < b;
             }
+
+            return a.size() < b.size();
         }
-    }
+    );
+
+    return frequentItemsetVector;
 }
 
 
 void FrequentItemset::saveFile(const QVector<QVector<int>> &frequentItemsets)
 {
+    PROFILE_SCOPE("save");
+    PROFILE_COUNT("itemsets emitted", frequentItemsets.size());
+
     QFile file(_outputFilePath);
     if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         QMessageBox::critical(nullptr, "Error", "Unable to open the output file");
@@ -623,6 +775,10 @@ void FrequentItemset::saveFile(const QVector<QVector<int>> &frequentItemsets)
     const int itemsetWidth = 20;
     const int supportWidth = 30;
 
+    if(_topK > 0) {
+        out << QString("Top-%1 frequent itemsets, #SUP >= %2").arg(_topK).arg(_minSupport) << "\n";
+    }
+
     for(QVector<int> set : frequentItemsets) {
         int support = _frequentItemsets[set];
         double supportPerc = static_cast<double>(support) / _sortedTransactions.size() * 100;
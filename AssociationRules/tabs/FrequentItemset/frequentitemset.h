@@ -7,10 +7,19 @@
 #include <QFileDialog>
 #include <QGraphicsScene>
 #include <QGraphicsTextItem>
+#include <QGraphicsEllipseItem>
+#include <QGraphicsLineItem>
 #include <QMap>
+#include <QHash>
 #include <QTextEdit>
 #include <QDesktopServices>
 
+#include "../../common/transactioncache.h"
+#include "../../common/topkminer.h"
+#include "../../common/itemconstraints.h"
+#include "../../common/parallelfpgrowth.h"
+#include "../../common/profiler.h"
+
 
 class FrequentItemset
 {
@@ -25,6 +34,11 @@ public:
     QString getInputFilePath();
     QString getOutputFilePath();
 
+    // Setters
+    void setTopK(const int topK);
+    void setItemConstraints(const ItemConstraints &constraints);
+    void setThreadsCount(const int threadsCount);
+
     // Slots
     QString onBrowseButtonClicked();
     QString onChangeButtonClicked();
@@ -32,6 +46,27 @@ public:
     void onForwardButtonClicked(QGraphicsScene *scene);
 
 private:
+    struct TreeNode
+    {
+        int item;
+        int support;
+        int parent;
+        QVector<int> children;
+        QPointF position;
+        QGraphicsEllipseItem *ellipse;
+        QGraphicsTextItem *text;
+        QGraphicsLineItem *edge;
+
+        // Tidy layout state (Walker's algorithm in linear time)
+        double prelim;
+        double modifier;
+        double shift;
+        double change;
+        int thread;
+        int ancestor;
+        int number;
+    };
+
     // Fields
     QString _inputFilePath;
     QString _outputFilePath;
@@ -39,29 +74,53 @@ private:
     QString _outputOpenFilePath;
     int _nodeRadius;
     QTextEdit *_editor;
-    QMap<QVector<int>, int> _nodesSupport;
     QVector<QVector<int>> _transactions;
     QMap<int, int> _itemsFrequencies;
-    QMap<QVector<int>, int> _setsFrequencies;
     QVector<QVector<int>> _sortedTransactions;
-    QMap<QVector<int>, QVector<QVector<int>>> _childrenMap;
-    QMap<QVector<int>, QVector<QVector<int>>> _currentChildrenMap;
-    QMap<QVector<int>, QPointF> _nodePositions;
-    QVector<QGraphicsEllipseItem*> _pendingRemovalEllipses;
+    QVector<TreeNode> _treeNodes;
+    QHash<int, QVector<int>> _itemsNodes;
+    QVector<int> _stepItems;
+    int _stepIndex;
     bool _removalColoring;
     double _minSupport;
+    int _topK;
+    ItemConstraints _constraints;
+    int _threadsCount;
     QMap<QVector<int>, int> _frequentItemsets;
 
     // Functions
     bool readFile();
+    void removeExcludedItems();
     void findItemFrequencies();
+    bool itemPrecedes(const int a, const int b);
     void sortTransactions();
-    void findSetsFrequencies();
     void removeRareItemsets();
-    void findChildren();
-    bool childExists(const QVector<QVector<int>> &childrenList, const QVector<int> &child);
+    void buildTree();
+    QVector<int> nodePath(const int node);
+    bool isFrequent(const int support);
+    QMap<int, int> baseCounts(const QVector<QPair<QVector<int>, int>> &base);
+    void mineConditionalBase(
+        const QVector<QPair<QVector<int>, int>> &base,
+        const QVector<int> &suffix,
+        QVector<QPair<QVector<int>, int>> &found
+    );
+    QString itemsetText(const QVector<int> &itemset);
+    void layoutTree();
+    void firstWalk(const int node);
+    int apportion(const int node, int defaultAncestor);
+    void moveSubtree(const int left, const int right, const double shift);
+    void executeShifts(const int node);
+    void secondWalk(const int node, const double modifier, const int depth);
+    int nextLeft(const int node);
+    int nextRight(const int node);
+    int leftSibling(const int node);
     void drawTree(QGraphicsScene *scene);
+    void mineParallel();
+    QVector<QVector<int>> sortFrequentItemsets();
     void saveFile(const QVector<QVector<int>> &frequentItemsets);
+
+    // arules_bench builds the FP-tree without a scene to draw it on.
+    friend class BenchmarkAccess;
 };
 
 
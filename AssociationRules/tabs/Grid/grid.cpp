@@ -12,6 +12,14 @@ Grid::Grid()
     _outputFilePath = absoluteRootPath + "/AssociationRules/resources/Grid/output.txt";
 
     _gridWidth = 0;
+    _transactionsCount = 0;
+    _memoryBudget = 0;
+    _workersCount = 1;
+    _incremental = false;
+    _sampleSize = 0;
+    _topK = 0;
+    _topKClosed = false;
+    _topKMinCount = 0;
 
     _closedAndMaximalItemsetsBrush = QBrush(Qt::cyan, Qt::SolidPattern);
     _maximalItemsetsBrush = QBrush(Qt::green, Qt::SolidPattern);
@@ -34,6 +42,43 @@ QString Grid::getOutputFilePath()
 }
 
 
+void Grid::setMemoryBudget(const qint64 memoryBudget)
+{
+    _memoryBudget = memoryBudget;
+}
+
+
+void Grid::setWorkersCount(const int workersCount)
+{
+    _workersCount = workersCount;
+}
+
+
+void Grid::setIncremental(const bool incremental)
+{
+    _incremental = incremental;
+}
+
+
+void Grid::setSampleSize(const int sampleSize)
+{
+    _sampleSize = sampleSize;
+}
+
+
+void Grid::setTopK(const int topK, const bool closed)
+{
+    _topK = topK;
+    _topKClosed = closed;
+}
+
+
+void Grid::setItemConstraints(const ItemConstraints &constraints)
+{
+    _constraints = constraints;
+}
+
+
 QString Grid::onBrowseButtonClicked()
 {
     QString filePath = QFileDialog::getOpenFileName(
@@ -76,17 +121,55 @@ void Grid::onRunAlgorithmButtonClicked(QGraphicsScene *scene, const double minSu
 {
     _transactions.clear();
     scene->clear();
-    QSet<int> gridItems;
 
-    bool readFileSuccess = readFile(gridItems);
-    if(!readFileSuccess) {
-        return;
+    QVector<QVector<int>> gridSets;
+    QVector<int> gridSupports;
+    QMap<QVector<int>, int> frequentItemsets;
+
+    if(_incremental || _sampleSize > 0 || _memoryBudget > 0 || _workersCount > 1) {
+        bool mineSuccess;
+        if(_incremental) {
+            mineSuccess = mineIncremental(minSupport, frequentItemsets);
+        } else if(_sampleSize > 0) {
+            mineSuccess = mineSampled(minSupport, frequentItemsets);
+        } else {
+            mineSuccess = minePartitioned(minSupport, frequentItemsets);
+        }
+        if(!mineSuccess) {
+            return;
+        }
+
+        // The full lattice is out of reach here, so only the frequent part is drawn.
+        for(const auto &pair : sortBySetSize(frequentItemsets)) {
+            gridSets.append(pair.first);
+            gridSupports.append(pair.second);
+        }
+    } else {
+        QSet<int> gridItems;
+        bool readFileSuccess = readFile(gridItems);
+        if(!readFileSuccess) {
+            return;
+        }
+        _transactionsCount = _transactions.size();
+        removeExcludedItems(gridItems);
+
+        if(_topK > 0) {
+            // Top-k mining gives the itemsets directly, so only they are drawn.
+            frequentItemsets = mineTopK();
+            for(const auto &pair : sortBySetSize(frequentItemsets)) {
+                gridSets.append(pair.first);
+                gridSupports.append(pair.second);
+            }
+        } else {
+            gridSets = findAllSets(gridItems);
+            gridSupports = findAllSupports(gridSets);
+            frequentItemsets = generateFrequentItemsets(minSupport);
+        }
     }
 
-    QVector<QVector<int>> gridSets = findAllSets(gridItems);
-    QVector<int> gridSupports = findAllSupports(gridSets);
+    PROFILE_COUNT("transactions scanned", _transactionsCount);
+
     QMap<QVector<int>, QVector<QVector<int>>> childrenMap = findChildren(gridSets);
-    QMap<QVector<int>, int> frequentItemsets = generateFrequentItemsets(minSupport);
     QVector<QVector<int>> frequentKeys = frequentItemsets.keys().toVector();
     QVector<QVector<int>> closedItemsets = findClosedItemsets(frequentItemsets);
     QVector<QVector<int>> maximalItemsets = findMaximalItemsets(frequentItemsets);
@@ -121,11 +204,24 @@ void Grid::onRunAlgorithmButtonClicked(QGraphicsScene *scene, const double minSu
 
 bool Grid::readFile(QSet<int> &gridItems)
 {
+    PROFILE_SCOPE("read");
+
+    TransactionCache cache(_inputFilePath);
+    if(cache.load(_transactions)) {
+        QMap<int, int> itemFrequencies = cache.getItemFrequencies();
+        for(auto it = itemFrequencies.cbegin(); it != itemFrequencies.cend(); it++) {
+            gridItems.insert(it.key());
+        }
+
+        return true;
+    }
+
     QFile file(_inputFilePath);
     if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QMessageBox::critical(nullptr, "Error", "Unable to open the input file");
         return false;
     }
+    PROFILE_COUNT("bytes parsed", file.size());
 
     QTextStream in(&file);
     while(!in.atEnd()) {
@@ -159,12 +255,119 @@ bool Grid::readFile(QSet<int> &gridItems)
 
     file.close();
 
+    cache.save(_transactions);
+
+    return true;
+}
+
+
+void Grid::removeExcludedItems(QSet<int> &gridItems)
+{
+    if(_constraints.getExcludedItems().isEmpty()) {
+        return;
+    }
+
+    for(int item : _constraints.getExcludedItems()) {
+        gridItems.remove(item);
+    }
+
+    for(QVector<int> &transaction : _transactions) {
+        transaction = _constraints.removeExcluded(transaction);
+    }
+}
+
+
+bool Grid::minePartitioned(const double minSupport, QMap<QVector<int>, int> &frequentItemsets)
+{
+    if(_workersCount > 1) {
+        DistributedMiner miner(_inputFilePath, _workersCount, _memoryBudget);
+        if(!miner.mine(minSupport, frequentItemsets)) {
+            QMessageBox::critical(nullptr, "Error", miner.getErrorString());
+            return false;
+        }
+
+        _transactionsCount = miner.getTransactionsCount();
+    } else {
+        PartitionMiner miner(_inputFilePath, _memoryBudget);
+        if(!miner.mine(minSupport, frequentItemsets)) {
+            QMessageBox::critical(nullptr, "Error", miner.getErrorString());
+            return false;
+        }
+
+        _transactionsCount = miner.getTransactionsCount();
+    }
+    frequentItemsets[QVector<int>()] = _transactionsCount;
+
+    return true;
+}
+
+
+bool Grid::mineIncremental(const double minSupport, QMap<QVector<int>, int> &frequentItemsets)
+{
+    IncrementalMiner miner(_inputFilePath, _outputFilePath + ".fup");
+    if(!miner.mine(minSupport, frequentItemsets)) {
+        QMessageBox::critical(nullptr, "Error", miner.getErrorString());
+        return false;
+    }
+
+    _transactionsCount = miner.getTransactionsCount();
+    frequentItemsets[QVector<int>()] = _transactionsCount;
+
+    return true;
+}
+
+
+QMap<QVector<int>, int> Grid::mineTopK()
+{
+    PROFILE_SCOPE("top-k");
+
+    // Frequent mode gives every itemset at or above the k-th support, closed
+    // mode the closed ones only; maximal itemsets are closed as well, so
+    // findMaximalItemsets finds them in either result.
+    TopKMiner miner(_transactions);
+    QMap<QVector<int>, int> topKItemsets = _topKClosed ? miner.mineClosed(_topK) : miner.mineFrequent(_topK);
+    _topKMinCount = miner.getMinCount();
+
+    QMap<QVector<int>, int> frequentItemsets;
+    for(auto it = topKItemsets.cbegin(); it != topKItemsets.cend(); it++) {
+        if(_constraints.isSatisfied(it.key())) {
+            frequentItemsets[it.key()] = it.value();
+        }
+    }
+    frequentItemsets[QVector<int>()] = _transactionsCount;
+
+    return frequentItemsets;
+}
+
+
+bool Grid::mineSampled(const double minSupport, QMap<QVector<int>, int> &frequentItemsets)
+{
+    SamplingMiner miner(_inputFilePath, _sampleSize);
+    QMap<QVector<int>, int> negativeBorder;
+    if(!miner.mine(minSupport, frequentItemsets, negativeBorder)) {
+        QMessageBox::critical(nullptr, "Error", miner.getErrorString());
+        return false;
+    }
+
+    if(miner.isFallbackUsed()) {
+        QMessageBox::information(
+            nullptr,
+            "Sampling",
+            "A negative border itemset of the sample was frequent, so an exact second pass was required"
+        );
+    }
+
+    _transactionsCount = miner.getTransactionsCount();
+    frequentItemsets[QVector<int>()] = _transactionsCount;
+
     return true;
 }
 
 
 QVector<QVector<int>> Grid::findAllSets(const QSet<int> &gridItems)
 {
+    PROFILE_SCOPE("enumerate");
+
     QVector<QVector<int>> allSets;
     allSets.append(QVector<int>());
     QVector<int> items = QVector<int>(gridItems.begin(), gridItems.end());
@@ -180,6 +383,14 @@ QVector<QVector<int>> Grid::findAllSets(const QSet<int> &gridItems)
         }
     }
 
+    // With required items the lattice keeps its root and the sets holding one.
+    if(!_constraints.getRequiredItems().isEmpty()) {
+        auto unsatisfied = [this](const QVector<int> &set) {
+            return !set.isEmpty() && !_constraints.isSatisfied(set);
+        };
+        allSets.erase(std::remove_if(allSets.begin(), allSets.end(), unsatisfied), allSets.end());
+    }
+
     std::sort(allSets.begin(), allSets.end(),
         [](const QVector<int> &a, const QVector<int> &b) {
             if(a.size() == b.size()) {
@@ -188,6 +399,7 @@ QVector<QVector<int>> Grid::findAllSets(const QSet<int> &gridItems)
             return a.size() < b.size();
         }
     );
+    PROFILE_COUNT("candidates generated", allSets.size());
 
     return allSets;
 }
@@ -195,6 +407,8 @@ QVector<QVector<int>> Grid::findAllSets(const QSet<int> &gridItems)
 
 QVector<int> Grid::findAllSupports(const QVector<QVector<int>> &gridSets)
 {
+    PROFILE_SCOPE("count");
+
     QVector<int> supports;
     for(const QVector<int> &set : gridSets) {
         int count = 0;
@@ -222,6 +436,8 @@ QVector<int> Grid::findAllSupports(const QVector<QVector<int>> &gridSets)
 
 QMap<QVector<int>, QVector<QVector<int>>> Grid::findChildren(QVector<QVector<int>> &gridSets)
 {
+    PROFILE_SCOPE("draw");
+
     QMap<QVector<int>, QVector<QVector<int>>> childrenMap;
 
     for(const QVector<int> &parent : gridSets) {
@@ -244,16 +460,28 @@ QMap<QVector<int>, QVector<QVector<int>>> Grid::findChildren(QVector<QVector<int
 
 QMap<QVector<int>, int> Grid::generateFrequentItemsets(const double minSupport)
 {
+    PROFILE_SCOPE("classify");
+
     QMap<QVector<int>, int> frequentItemsets;
 
+    bool hasRequiredItems = !_constraints.getRequiredItems().isEmpty();
     for(QVector<int> &transaction : _transactions) {
+        // A transaction without a required item only supports the empty set.
+        if(hasRequiredItems && !_constraints.isSatisfied(transaction)) {
+            frequentItemsets[QVector<int>()]++;
+            continue;
+        }
+
         QVector<QVector<int>> subsets = generateSubsets(transaction);
         for(const QVector<int> &subset : subsets) {
+            if(hasRequiredItems && !subset.isEmpty() && !_constraints.isSatisfied(subset)) {
+                continue;
+            }
             frequentItemsets[subset]++;
         }
     }
 
-    double transactionsSize = _transactions.size();
+    double transactionsSize = _transactionsCount;
     for(auto it = frequentItemsets.begin(); it != frequentItemsets.end(); ) {
         if((it.value() / transactionsSize) < minSupport) {
             it = frequentItemsets.erase(it);
@@ -268,6 +496,9 @@ QMap<QVector<int>, int> Grid::generateFrequentItemsets(const double minSupport)
 
 QVector<QVector<int>> Grid::findClosedItemsets(const QMap<QVector<int>, int> &frequentItemsets)
 {
+    PROFILE_SCOPE("classify");
+    TRACE_SCOPE("closure check");
+
     QVector<QVector<int>> closedItemsets;
 
     for(auto it1 = frequentItemsets.begin(); it1 != frequentItemsets.end(); it1++) {
@@ -294,6 +525,9 @@ QVector<QVector<int>> Grid::findClosedItemsets(const QMap<QVector<int>, int> &fr
 
 QVector<QVector<int>> Grid::findMaximalItemsets(const QMap<QVector<int>, int> &frequentItemsets)
 {
+    PROFILE_SCOPE("classify");
+    TRACE_SCOPE("maximality check");
+
     QVector<QVector<int>> maximalItemsets;
 
     for(auto it1 = frequentItemsets.begin(); it1 != frequentItemsets.end(); it1++) {
@@ -323,6 +557,8 @@ QVector<QVector<int>> Grid::findClosedAndMaximalItemsets(
     const QVector<QVector<int>> &maximalItemsets
 )
 {
+    PROFILE_SCOPE("classify");
+
     QVector<QVector<int>> closedAndMaximalItemsets;
 
     for(const auto &closedItemset : closedItemsets) {
@@ -347,6 +583,8 @@ void Grid::drawGrid(
     const QVector<QVector<int>> &maximalAndClosedItemsets
 )
 {
+    PROFILE_SCOPE("draw");
+
     QMap<QVector<int>, QPointF> nodePositions;
 
     const int nodeRadius = 25;
@@ -413,7 +651,7 @@ void Grid::drawGrid(
                 setText->setPos(x - setText->boundingRect().width() / 2, y - setText->boundingRect().height() / 2 - 5);
                 setText->setDefaultTextColor(Qt::black);
 
-                double supportPerc = (gridSupports[index] / static_cast<double>(_transactions.size())) * 100;
+                double supportPerc = (gridSupports[index] / static_cast<double>(_transactionsCount)) * 100;
                 QString supportStr = "(" + QString::number(supportPerc) + " %)";
                 QGraphicsTextItem *supportText = scene->addText(supportStr);
                 supportText->setFont(font);
@@ -456,25 +694,28 @@ bool Grid::saveFile(
     const QVector<QVector<int>> &closedAndMaximalItemsets
 )
 {
+    PROFILE_SCOPE("save");
+    PROFILE_COUNT("itemsets emitted", frequentItemsets.size());
+
     QFile file(_outputFilePath);
     if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         QMessageBox::critical(nullptr, "Error", "Unable to open the output file");
         return false;
     }
 
-    const int itemsetWidth = 20;
-    const int supportWidth = 30;
-    const int categoryWidth = 20;
-
     QTextStream out(&file);
+    if(_topK > 0) {
+        out << QString("Top-%1 %2 itemsets, #SUP >= %3")
+            .arg(_topK)
+            .arg(_topKClosed ? "closed" : "frequent")
+            .arg(_topKMinCount) << "\n";
+    }
+
     for(const auto &pair : frequentItemsets) {
         const QVector<int> &itemset = pair.first;
         if(itemset.size() == 0)
             continue;
 
-        int support = pair.second;
-        double supportPerc = static_cast<double>(support) / _transactions.size() * 100;
-
         QString category;
         if (closedAndMaximalItemsets.contains(itemset)) {
             category = "Closed and Maximal";
@@ -486,19 +727,7 @@ bool Grid::saveFile(
             category = "Frequent";
         }
 
-        QString itemsetString = "{";
-        for(int item : itemset) {
-            itemsetString += QString::number(item) + ", ";
-        }
-        itemsetString = itemsetString.removeLast().removeLast();
-        itemsetString += "}";
-
-        out << itemsetString.leftJustified(itemsetWidth)
-            << QString("#SUP: %1 (%2%)")
-               .arg(support)
-               .arg(supportPerc)
-               .leftJustified(supportWidth)
-            << category.leftJustified(categoryWidth) << "\n";
+        out << ItemsetWriter::formatItemset(itemset, pair.second, _transactionsCount, category) << "\n";
     }
 
     file.close();
@@ -535,21 +764,5 @@ QVector<QVector<int>> Grid::generateSubsets(const QVector<int> &set)
 
 QVector<QPair<QVector<int>, int>> Grid::sortBySetSize(const QMap<QVector<int>, int> &frequentItemsets) 
 {
-    QVector<QPair<QVector<int>, int>> itemList;
-
-    for(auto it = frequentItemsets.cbegin(); it != frequentItemsets.cend(); it++) {
-        itemList.append(qMakePair(it.key(), it.value()));
-    }
-
-    std::sort(itemList.begin(), itemList.end(), 
-        [](const QPair<QVector<int>, int> &a, const QPair<QVector<int>, int> &b) {
-            if(a.first.size() == b.first.size()) {
-                return a.first < b.first;
-            }
-
-            return a.first.size() < b.first.size();
-        }
-    );
-
-    return itemList;
+    return ItemsetWriter::sortBySetSize(frequentItemsets);
 }
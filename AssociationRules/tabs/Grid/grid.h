@@ -15,6 +15,16 @@
 
 #include <cmath>
 
+#include "../../common/transactioncache.h"
+#include "../../common/partitionminer.h"
+#include "../../common/distributedminer.h"
+#include "../../common/incrementalminer.h"
+#include "../../common/samplingminer.h"
+#include "../../common/topkminer.h"
+#include "../../common/itemconstraints.h"
+#include "../../common/itemsetwriter.h"
+#include "../../common/profiler.h"
+
 
 class Grid
 {
@@ -26,6 +36,14 @@ public:
     QString getInputFilePath();
     QString getOutputFilePath();
 
+    // Setters
+    void setMemoryBudget(const qint64 memoryBudget);
+    void setWorkersCount(const int workersCount);
+    void setIncremental(const bool incremental);
+    void setSampleSize(const int sampleSize);
+    void setTopK(const int topK, const bool closed);
+    void setItemConstraints(const ItemConstraints &constraints);
+
     // Slots
     QString onBrowseButtonClicked();
     QString onChangeButtonClicked();
@@ -45,9 +63,23 @@ private:
     QString _inputOpenFilePath;
     QString _outputOpenFilePath;
     QVector<QVector<int>> _transactions;
+    int _transactionsCount;
+    qint64 _memoryBudget;
+    int _workersCount;
+    bool _incremental;
+    int _sampleSize;
+    int _topK;
+    bool _topKClosed;
+    int _topKMinCount;
+    ItemConstraints _constraints;
 
     // Functions
     bool readFile(QSet<int> &gridItems);
+    void removeExcludedItems(QSet<int> &gridItems);
+    bool minePartitioned(const double minSupport, QMap<QVector<int>, int> &frequentItemsets);
+    bool mineIncremental(const double minSupport, QMap<QVector<int>, int> &frequentItemsets);
+    bool mineSampled(const double minSupport, QMap<QVector<int>, int> &frequentItemsets);
+    QMap<QVector<int>, int> mineTopK();
     QVector<QVector<int>> findAllSets(const QSet<int> &gridItems);
     QVector<int> findAllSupports(const QVector<QVector<int>> &gridSets);
     QMap<QVector<int>, QVector<QVector<int>>> findChildren(QVector<QVector<int>> &gridSets);
@@ -77,6 +109,9 @@ private:
 
     QVector<QVector<int>> generateSubsets(const QVector<int> &set);
     QVector<QPair<QVector<int>, int>> sortBySetSize(const QMap<QVector<int>, int> &frequentItemsets);
+
+    // arules_bench times readFile and each lattice step on its own.
+    friend class BenchmarkAccess;
 };
 
 
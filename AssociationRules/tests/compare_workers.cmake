@@ -0,0 +1,28 @@
+# Runs "mine" on INPUT once in a single process and once with WORKERS worker
+# processes, and fails unless both write the same output file.
+#
+#   cmake -DBINARY=<AssociationRules> -DINPUT=<file> -DWORKERS=<n>
+#         -DMIN_SUPPORT=<support> -DWORK_DIR=<dir> -P compare_workers.cmake
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+foreach(workers 1 ${WORKERS})
+    set(output "${WORK_DIR}/workers_${workers}.txt")
+    execute_process(
+        COMMAND "${BINARY}" mine --input "${INPUT}" --output "${output}"
+                --min-support ${MIN_SUPPORT} --workers ${workers}
+        RESULT_VARIABLE result
+        ERROR_VARIABLE errors
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "mine --workers ${workers} failed (${result}): ${errors}")
+    endif()
+endforeach()
+
+execute_process(
+    COMMAND "${CMAKE_COMMAND}" -E compare_files "${WORK_DIR}/workers_1.txt" "${WORK_DIR}/workers_${WORKERS}.txt"
+    RESULT_VARIABLE different
+)
+if(different)
+    message(FATAL_ERROR "mine --workers ${WORKERS} differs from the single process output in ${WORK_DIR}")
+endif()